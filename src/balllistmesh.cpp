@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "balllistmesh.h"
+#include <GL/glu.h>
+
+BallListMesh::BallListMesh(QGLWidget *gl, const std::vector<Qsip_spin_3_Z> &centers,
+                           double radius, int slices, int stacks)
+    : Mesh(gl),
+      m_radius(radius),
+      m_slices(slices),
+      m_stacks(stacks)
+{
+    m_centers.reserve(3 * centers.size());
+
+    for (std::vector<Qsip_spin_3_Z>::const_iterator it = centers.begin(); it != centers.end(); ++it)
+    {
+        m_centers.push_back(it->s12());
+        m_centers.push_back(it->s23());
+        m_centers.push_back(it->s31());
+    }
+}
+
+void BallListMesh::drawMesh()
+{
+    GLUquadric *quadric;
+
+    // quadric
+    quadric = gluNewQuadric();
+    gluQuadricNormals(quadric, GLU_SMOOTH);
+
+    // draw
+    for (size_t index = 0; index + 2 < m_centers.size(); index += 3)
+    {
+        glPushMatrix();
+            glTranslated(m_centers[index], m_centers[index + 1], m_centers[index + 2]);
+            gluSphere(quadric, m_radius, m_slices, m_stacks);
+        glPopMatrix();
+    }
+
+    // done
+    gluDeleteQuadric(quadric);
+}
@@ -0,0 +1,45 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BALLLISTMESH_H
+#define BALLLISTMESH_H
+
+#include "mesh.h"
+#include "kernel.h"
+#include <vector>
+
+// balls of one radius centered at spins, in s12, s23, s31
+class BallListMesh
+    : public Mesh
+{
+public:
+    BallListMesh(QGLWidget *gl, const std::vector<Qsip_spin_3_Z> &centers,
+                 double radius, int slices, int stacks);
+
+protected:
+    virtual void        drawMesh();
+
+private:
+    std::vector<double> m_centers;
+    double              m_radius;
+    int                 m_slices;
+    int                 m_stacks;
+};
+
+#endif // BALLLISTMESH_H
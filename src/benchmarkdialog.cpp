@@ -19,10 +19,62 @@
  */
 #include "benchmarkdialog.h"
 #include "sceneloader.h"
+#include "exactsceneconverter.h"
 #include <cs/Benchmark.h>
 #include <QtGlobal>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QElapsedTimer>
+#include <algorithm>
 #include "ui_benchmarkdialog.h"
 
+namespace // anonymous
+{
+const int EXACT_CONSTRUCTION_RUNS = 3;
+const int SCENE_LOADING_RUNS = 5;
+const int DECIMAL_ARITHMETIC_RUNS = 5;
+
+// sum of squared face normals, with decNumber only
+QDecNumber decNumberNormals(const std::vector<QDecNumber> &coordinates, const DecimalFaceList &faces)
+{
+    QDecNumber sum(0);
+
+    for (DecimalFaceList::const_iterator it = faces.begin(); it != faces.end(); ++it)
+    {
+        const QDecNumber *a = &coordinates[3 * it->vertex(0)];
+        const QDecNumber *b = &coordinates[3 * it->vertex(1)];
+        const QDecNumber *c = &coordinates[3 * it->vertex(2)];
+
+        QDecNumber ux = b[0] - a[0], uy = b[1] - a[1], uz = b[2] - a[2];
+        QDecNumber vx = c[0] - a[0], vy = c[1] - a[1], vz = c[2] - a[2];
+
+        QDecNumber nx = uy * vz - uz * vy;
+        QDecNumber ny = uz * vx - ux * vz;
+        QDecNumber nz = ux * vy - uy * vx;
+
+        sum = sum + nx * nx + ny * ny + nz * nz;
+    }
+
+    return sum;
+}
+
+// same with scene decimals
+QDecimal sceneNormals(const DecimalVectorList &vertices, const DecimalFaceList &faces)
+{
+    QDecimal sum(0);
+
+    for (DecimalFaceList::const_iterator it = faces.begin(); it != faces.end(); ++it)
+    {
+        DecimalTriangle triangle(&vertices[it->vertex(0)], &vertices[it->vertex(1)], &vertices[it->vertex(2)]);
+        sum += triangle.normal().squaredLength();
+    }
+
+    return sum;
+}
+} // namespace anonymous
+
 BenchmarkDialog::BenchmarkDialog(QWidget *parent) :
     QDialog(parent),
     m_rand(static_cast<quint32>(time(0))),
@@ -42,6 +94,32 @@ BenchmarkDialog::~BenchmarkDialog()
 
 void BenchmarkDialog::on_pushButtonRun_clicked()
 {
+    SceneSnapshotPtr sceneSnapshot;
+    QString directory;
+
+    // all but the H3 test run on a scene directory
+    if (ui->comboBoxScenario->currentIndex() != 0)
+    {
+        directory = QFileDialog::getExistingDirectory(this, tr("Open scene directory"));
+
+        if (directory.isEmpty())
+            return;
+    }
+
+    if (ui->comboBoxScenario->currentIndex() == 1)
+    {
+        std::pair<SceneObjectPtr, SceneObjectPtr> objects = SceneObject::loadFromDirectory(directory.toStdString().c_str());
+
+        if (!objects.first || !objects.second)
+            return (void)QMessageBox::warning(this, tr("Benchmark"), tr("Failed to load scene!"), QMessageBox::Ok);
+
+        std::vector<SceneObjectPtr> sceneObjects;
+        sceneObjects.push_back(objects.first);
+        sceneObjects.push_back(objects.second);
+
+        sceneSnapshot.reset(new SceneSnapshot(sceneObjects, SceneObject::Type_DecimalTriangleList, 0));
+    }
+
     ui->pushButtonRun->setEnabled(false);
     ui->pushButtonAbort->setEnabled(true);
 
@@ -50,7 +128,7 @@ void BenchmarkDialog::on_pushButtonRun_clicked()
     ui->labelStatus->setText(tr("Running..."));
 
     // run
-    m_test.reset(new TestThread(ui->comboBoxScenario->currentIndex()));
+    m_test.reset(new TestThread(ui->comboBoxScenario->currentIndex(), sceneSnapshot, directory));
     connect(m_test.data(), SIGNAL(report(QString)), this, SLOT(report(QString)));
     connect(m_test.data(), SIGNAL(success()), this, SLOT(success()));
     m_test->start();
@@ -61,8 +139,10 @@ void BenchmarkDialog::report(QString message)
     ui->plainTextEditOutput->appendPlainText(message);
 }
 
-TestThread::TestThread(int test)
-    : m_test(test)
+TestThread::TestThread(int test, SceneSnapshotPtr sceneSnapshot, const QString &directory)
+    : m_test(test),
+      m_sceneSnapshot(sceneSnapshot),
+      m_directory(directory)
 {
 }
 
@@ -82,6 +162,18 @@ void TestThread::run()
             using std::placeholders::_1;
             benchmark.random_H3_intersection_test(5, std::bind(&TestThread::prereport, this, _1));
             break;
+
+        case 1: // exact scene construction
+            exactSceneConstruction();
+            break;
+
+        case 2: // scene loading
+            sceneLoading();
+            break;
+
+        case 3: // decimal arithmetic
+            decimalArithmetic();
+            break;
     }
 
     emit success();
@@ -92,6 +184,168 @@ void TestThread::prereport(const std::string &message)
     emit report(QString::fromStdString(message));
 }
 
+void TestThread::exactSceneConstruction()
+{
+    // compare integer backends by running this in differently configured builds
+    emit report(QString("Integer type: %1").arg(ARRANGEMENT_BIGINT_NAME));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const Triangle_list_3_Z &movable = m_sceneSnapshot->movableTrianglesZ();
+    const Triangle_list_3_Z &obstacle = m_sceneSnapshot->obstacleTrianglesZ();
+
+    emit report(QString("Scene: %1 movable, %2 obstacle triangles, converted in %3 ms")
+                .arg(movable.size()).arg(obstacle.size()).arg(timer.elapsed()));
+
+    qint64 best = 0;
+    qint64 total = 0;
+
+    for (int run = 0; run < EXACT_CONSTRUCTION_RUNS; ++run)
+    {
+        timer.restart();
+
+        Spin_configuration_space_3::Exact_TT_Z configuration;
+        configuration.create_from_scene(movable.begin(), movable.end(),
+                                        obstacle.begin(), obstacle.end(),
+                                        Spin_configuration_space_3::Exact_TT_Z::Parameters(false, false));
+
+        qint64 elapsed = timer.elapsed();
+
+        best = run ? std::min(best, elapsed) : elapsed;
+        total += elapsed;
+
+        emit report(QString("Run %1: %2 ms").arg(run + 1).arg(elapsed));
+    }
+
+    emit report(QString("Best: %1 ms, average: %2 ms").arg(best).arg(total / EXACT_CONSTRUCTION_RUNS));
+}
+
+void TestThread::sceneLoading()
+{
+    const char *fileNames[] = { "robot.txt", "obstacle.txt" };
+
+    for (size_t index = 0; index < sizeof(fileNames) / sizeof(fileNames[0]); ++index)
+    {
+        QString path = QDir(m_directory).filePath(fileNames[index]);
+        qint64 bytes = QFileInfo(path).size();
+
+        qint64 best = 0;
+        qint64 total = 0;
+
+        for (int run = 0; run < SCENE_LOADING_RUNS; ++run)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            SceneLoaderPtr loader = SceneLoader::load(path.toLocal8Bit().constData());
+
+            qint64 elapsed = timer.nsecsElapsed();
+
+            if (!loader)
+            {
+                emit report(QString("Failed to load %1").arg(path));
+                return;
+            }
+
+            if (!run)
+                emit report(QString("%1: %2 bytes, %3 vertices, %4 faces")
+                            .arg(fileNames[index]).arg(bytes).arg(loader->vertices().size()).arg(loader->faces().size()));
+
+            best = run ? std::min(best, elapsed) : elapsed;
+            total += elapsed;
+        }
+
+        // bytes per nanosecond is gigabytes per second
+        emit report(QString("Best: %1 ms (%2 MB/s), average: %3 ms")
+                    .arg(best / 1e6, 0, 'f', 2)
+                    .arg(best ? bytes * 1e3 / best : 0.0, 0, 'f', 1)
+                    .arg(total / SCENE_LOADING_RUNS / 1e6, 0, 'f', 2));
+    }
+}
+
+void TestThread::decimalArithmetic()
+{
+    QString path = QDir(m_directory).filePath("robot.txt");
+    SceneLoaderPtr loader = SceneLoader::load(path.toLocal8Bit().constData());
+
+    if (!loader)
+    {
+        emit report(QString("Failed to load %1").arg(path));
+        return;
+    }
+
+    const DecimalVectorList &vertices = loader->vertices();
+    const DecimalFaceList &faces = loader->faces();
+
+    std::vector<QDecNumber> coordinates;
+    coordinates.reserve(3 * vertices.size());
+
+    size_t fast = 0;
+
+    for (DecimalVectorList::const_iterator it = vertices.begin(); it != vertices.end(); ++it)
+    {
+        const QDecimal *values[] = { &it->x(), &it->y(), &it->z() };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            coordinates.push_back(values[i]->toDecNumber());
+            fast += values[i]->isFast();
+        }
+    }
+
+    emit report(QString("robot.txt: %1 vertices, %2 faces, %3 of %4 coordinates on the fast path")
+                .arg(vertices.size()).arg(faces.size()).arg(fast).arg(coordinates.size()));
+
+    qint64 bestDecNumber = 0;
+    qint64 bestScene = 0;
+    qint64 bestConversion = 0;
+
+    for (int run = 0; run < DECIMAL_ARITHMETIC_RUNS; ++run)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QDecNumber decNumberSum = decNumberNormals(coordinates, faces);
+
+        qint64 decNumberElapsed = timer.nsecsElapsed();
+        timer.restart();
+
+        QDecimal sceneSum = sceneNormals(vertices, faces);
+
+        qint64 sceneElapsed = timer.nsecsElapsed();
+        timer.restart();
+
+        ExactSceneConverter converter;
+
+        for (DecimalVectorList::const_iterator it = vertices.begin(); it != vertices.end(); ++it)
+        {
+            converter.add(it->x());
+            converter.add(it->y());
+            converter.add(it->z());
+        }
+
+        converter.convert();
+
+        qint64 conversionElapsed = timer.nsecsElapsed();
+
+        // both paths must agree to the last digit
+        if (!run && QDecimal(decNumberSum) != sceneSum)
+            emit report(QString("Normals differ: %1 and %2").arg(decNumberSum.toString().constData()).arg(sceneSum.toString().constData()));
+
+        bestDecNumber = run ? std::min(bestDecNumber, decNumberElapsed) : decNumberElapsed;
+        bestScene = run ? std::min(bestScene, sceneElapsed) : sceneElapsed;
+        bestConversion = run ? std::min(bestConversion, conversionElapsed) : conversionElapsed;
+    }
+
+    emit report(QString("Normals: decNumber %1 ms, scene decimals %2 ms (%3x)")
+                .arg(bestDecNumber / 1e6, 0, 'f', 2)
+                .arg(bestScene / 1e6, 0, 'f', 2)
+                .arg(bestScene ? static_cast<double>(bestDecNumber) / bestScene : 0.0, 0, 'f', 1));
+
+    emit report(QString("Exact conversion: %1 ms").arg(bestConversion / 1e6, 0, 'f', 2));
+}
+
 void BenchmarkDialog::on_pushButtonAbort_clicked()
 {
     m_test.reset();
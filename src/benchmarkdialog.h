@@ -21,6 +21,7 @@
 #define BENCHMARKDIALOG_H
 
 #include "variantpredicate.h"
+#include "scenesnapshot.h"
 #include <QRandomGenerator>
 #include <QScopedPointer>
 #include <QDialog>
@@ -37,11 +38,16 @@ class TestThread: public QThread
 
 private:
     int m_test;
+    SceneSnapshotPtr m_sceneSnapshot;
+    QString m_directory;
 
     void prereport(const std::string &message);
+    void exactSceneConstruction();
+    void sceneLoading();
+    void decimalArithmetic();
 
 public:
-    TestThread(int test);
+    TestThread(int test, SceneSnapshotPtr sceneSnapshot = SceneSnapshotPtr(), const QString &directory = QString());
     ~TestThread();
 
     virtual void run();
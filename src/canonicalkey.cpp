@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "canonicalkey.h"
+#include "kernel.h"
+#include <QMutexLocker>
+#include <sstream>
+#include <vector>
+#include <cctype>
+
+namespace // anonymous
+{
+struct Coefficient
+{
+    size_t      begin;      // first character, including the sign
+    size_t      end;        // one past the last digit
+    Z           value;
+    bool        implicit;   // unit coefficient of a term starting with a variable
+};
+
+bool isIdentifierCharacter(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// start of a coefficient at index, including a preceding sign; spaces
+// between are allowed
+size_t signedBegin(const std::string &text, size_t index, bool &negative)
+{
+    size_t sign = index;
+
+    while (sign > 0 && text[sign - 1] == ' ')
+        --sign;
+
+    negative = false;
+
+    if (sign > 0 && (text[sign - 1] == '-' || text[sign - 1] == '+'))
+    {
+        negative = (text[sign - 1] == '-');
+        return sign - 1;
+    }
+
+    return index;
+}
+
+bool isTermSeparator(char c)
+{
+    return c == '+' || c == '-' || c == '(' || c == '[' || c == ',' || c == ';' || c == '=';
+}
+
+std::vector<Coefficient> findCoefficients(const std::string &text)
+{
+    std::vector<Coefficient> coefficients;
+    bool termStart = true;
+    size_t index = 0;
+
+    while (index < text.size())
+    {
+        char c = text[index];
+
+        // a term which starts with a variable has an implicit unit coefficient
+        if (termStart && std::isalpha(static_cast<unsigned char>(c)))
+        {
+            bool negative;
+
+            Coefficient coefficient;
+            coefficient.begin = signedBegin(text, index, negative);
+            coefficient.end = index;
+            coefficient.value = Z(negative ? -1 : 1);
+            coefficient.implicit = true;
+
+            coefficients.push_back(coefficient);
+            termStart = false;
+
+            while (index < text.size() && isIdentifierCharacter(text[index]))
+                ++index;
+
+            continue;
+        }
+
+        if (!std::isdigit(static_cast<unsigned char>(c)))
+        {
+            if (c != ' ')
+                termStart = isTermSeparator(c);
+
+            ++index;
+            continue;
+        }
+
+        termStart = false;
+
+        size_t end = index;
+
+        while (end < text.size() && std::isdigit(static_cast<unsigned char>(text[end])))
+            ++end;
+
+        // skip exponents, identifiers and fractional parts
+        if (index > 0 && (text[index - 1] == '^' || text[index - 1] == '.' || isIdentifierCharacter(text[index - 1])))
+        {
+            index = end;
+            continue;
+        }
+
+        bool negative;
+
+        Coefficient coefficient;
+        coefficient.begin = signedBegin(text, index, negative);
+        coefficient.end = end;
+        coefficient.implicit = false;
+        stringToZ(text.substr(index, end - index).c_str(), coefficient.value);
+
+        if (negative)
+            coefficient.value = -coefficient.value;
+
+        coefficients.push_back(coefficient);
+        index = end;
+    }
+
+    return coefficients;
+}
+} // namespace anonymous
+
+std::string canonicalFormKey(const std::string &text)
+{
+    std::vector<Coefficient> coefficients = findCoefficients(text);
+
+    // common divisor and sign
+    Z divisor(0);
+    bool negate = false;
+    bool signFixed = false;
+
+    for (std::vector<Coefficient>::const_iterator it = coefficients.begin(); it != coefficients.end(); ++it)
+    {
+        if (it->value == Z(0))
+            continue;
+
+        if (!signFixed)
+        {
+            negate = it->value < Z(0);
+            signFixed = true;
+        }
+
+        divisor = greatestCommonDivisor(divisor, absolute(it->value));
+    }
+
+    if (divisor == Z(0))
+        return text;
+
+    // rebuild with normalized coefficients, every coefficient gets an explicit sign
+    std::ostringstream key;
+    size_t position = 0;
+
+    for (std::vector<Coefficient>::const_iterator it = coefficients.begin(); it != coefficients.end(); ++it)
+    {
+        key << text.substr(position, it->begin - position);
+
+        Z value = it->value / divisor;
+
+        if (negate)
+            value = -value;
+
+        if (value < Z(0))
+            key << '-' << absolute(value);
+        else
+            key << '+' << value;
+
+        // an implicit coefficient is written out, so that s12 and 1*s12 match
+        if (it->implicit)
+            key << '*';
+
+        position = it->end;
+    }
+
+    key << text.substr(position);
+    return key.str();
+}
+
+bool CanonicalKeySet::insert(const std::string &key)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_keys.insert(key).second;
+}
+
+size_t CanonicalKeySet::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_keys.size();
+}
@@ -0,0 +1,54 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CANONICALKEY_H
+#define CANONICALKEY_H
+
+#include <QMutex>
+#include <boost/noncopyable.hpp>
+#include <set>
+#include <string>
+
+// canonical text of a homogeneous integer form such as a spin quadric
+//
+// integer coefficients are divided by their gcd and the sign is chosen
+// so that the first nonzero coefficient is positive; proportional forms
+// have the same zero set and get the same key; digits of exponents and
+// of identifiers such as s12 are not coefficients and are kept verbatim
+//
+// a term starting with a variable, such as s12^2 or -s0*s12, has an
+// implicit coefficient of +1 or -1, which is written out in the key
+std::string canonicalFormKey(const std::string &text);
+
+// set of keys shared between meshing jobs
+class CanonicalKeySet
+    : private boost::noncopyable
+{
+public:
+    // true if the key was not present before
+    bool                    insert(const std::string &key);
+
+    size_t                  size() const;
+
+private:
+    mutable QMutex          m_mutex;
+    std::set<std::string>   m_keys;
+};
+
+#endif // CANONICALKEY_H
@@ -23,8 +23,8 @@
 #include "configurationspace.h"
 #include "genericrouter.h"
 #include "volumerenderergaussiansplatter.h"
+#include "voxelpointset.h"
 #include <QDataStream>
-#include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <stdexcept>
 
@@ -56,41 +56,54 @@ public:
         // create configuration space for given representation
         GenericRouter<Configuration> *cellRouter = new GenericRouter<Configuration>();
 
-        cellRouter->configuration().create_from_scene(robot_begin, robot_end,
-                                                      obstacle_begin, obstacle_end,
-                                                      parameters);
+        {
+            QMutexLocker locker(&kernelMutex());
+
+            cellRouter->configuration().create_from_scene(robot_begin, robot_end,
+                                                          obstacle_begin, obstacle_end,
+                                                          parameters);
+        }
 
         // assume that the representation is cell graph
         const Representation &rep = cellRouter->configuration().rep();
 
-        // prepare
-        size_t numberOfVoxels = parameters.sample_point_count();
-        boost::scoped_array<Voxel> voxels(new Voxel[numberOfVoxels]);
-        size_t index = 0;
+        // the renderer only draws full cells, count their samples first
+        typedef typename Representation::Cell::Sample_const_iterator Sample_const_iterator;
+        size_t numberOfFullSamples = 0;
 
-        // scan points
         for (Cell_const_iterator cellIterator = rep.cells_begin(); cellIterator != rep.cells_end(); ++cellIterator)
         {
-            typedef typename Representation::Cell::Sample_const_iterator Sample_const_iterator;
-            VoxelType voxelType;
+            if (cellIterator->is_empty())
+                continue;
+
+            for (Sample_const_iterator sampleIterator = cellIterator->samples_begin(); sampleIterator != cellIterator->samples_end(); ++sampleIterator)
+                if (sampleIterator->s0() >= 0)
+                    ++numberOfFullSamples;
+        }
+
+        VoxelPointSet voxels;
+        voxels.reserve(VoxelType_Real_Full, numberOfFullSamples);
 
-            // FIXME: take only one half-sphere !!! Do not mix them
+        // scan points
+        for (Cell_const_iterator cellIterator = rep.cells_begin(); cellIterator != rep.cells_end(); ++cellIterator)
+        {
             if (cellIterator->is_empty())
-                voxelType = VoxelType_Real_Empty;
-            else
-                voxelType = VoxelType_Real_Full;
+                continue;
 
             for (Sample_const_iterator sampleIterator = cellIterator->samples_begin(); sampleIterator != cellIterator->samples_end(); ++sampleIterator)
             {
-                assert(index < numberOfVoxels);
-                voxels[index++] = Voxel(voxelType,
-                                        sampleIterator->s12(),
-                                        sampleIterator->s23(),
-                                        sampleIterator->s31());
+                // take only the canonical half-sphere, samples of the other one are the same rotations
+                if (sampleIterator->s0() < 0)
+                    continue;
+
+                voxels.add(VoxelType_Real_Full,
+                           sampleIterator->s12(),
+                           sampleIterator->s23(),
+                           sampleIterator->s31());
             }
         }
 
-        m_volumeRendererGaussianSplatter.reset(new VolumeRendererGaussianSplatter(voxels.get(), voxels.get() + numberOfVoxels, m_gl));
+        m_volumeRendererGaussianSplatter.reset(new VolumeRendererGaussianSplatter(voxels, m_gl));
 
         // install route executor
         m_router.reset(cellRouter);
@@ -29,24 +29,34 @@
 #include "cellconfigurationspace.h"
 #include "exactconfigurationspace.h"
 #include "variantpredicatedialog.h"
+#include "neighbourcollectprofile.h"
+#include "spheretreeloader.h"
+#include "meshimporter.h"
 #include "qlog4cxx.h"
 #include "ui_clientform.h"
+#include <QApplication>
 #include <QTableWidgetItem>
+#include <QDir>
 #include <QFileDialog>
 #include <QTimer>
 #include <QFileInfo>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QCursor>
 #include <QIcon>
 #include <QMenu>
 #include <QTimer>
+#include <boost/bind.hpp>
+#include <log4cxx/logger.h>
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
 
 namespace // anonymous
 {
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.clientform"));
+
 static QString boolToString(bool value)
 {
     return value ? QObject::tr("yes") : QObject::tr("no");
@@ -72,50 +82,72 @@ QQuaternion quaternionFromEulerAngles(double roll, double pitch, double yaw)
     return QQuaternion(w, x, y, z);
 }
 
-int calculateNumberOfFractionDigits(const QDecimal &decimal)
-{
-    QDecimal reducedDecimal = decimal.reduce();
-    QByteArray buffer = reducedDecimal.toString();
+//const int MOTION_ANIMATION_TIME = 5000;
 
-    int dotIndex = buffer.indexOf('.');
+// arr files without this header are version 1 and start with the object count
+const quint32 ARR_MAGIC = 0x41525253;     // "ARRS"
 
-    if (dotIndex == -1)
-        return 0;
+// imports finished faster do not show a progress dialog
+const int SCENE_IMPORT_DIALOG_DELAY = 500;
 
-    return buffer.size() - 1 - dotIndex;
-}
+// only the view pages raster voxels, libcs builds and routes on a whole
+// in-memory raster of one byte per voxel, so the cap stays until it can stream
+const int MAXIMUM_RASTER_RESOLUTION = 256;
+
+// the s0 < 0 half of the raster is mirrored, so both halves need a voxel
+const int MINIMUM_RASTER_RESOLUTION = 2;
 
-void updateMaximumFractionDigits(int &numberOfFractionDigits, const QDecimal &decimal)
+// import tasks, run on workers
+bool loadTextTask(const std::string &fileName, bool rotating, bool mergeCoplanar, boost::shared_ptr<SceneObjectPtr> result, ImportProgress &progress)
 {
-    int fractionalDigits = calculateNumberOfFractionDigits(decimal);
+    // stl, ply and obj files go through the binary mesh importer
+    if (MeshImporter::format(fileName.c_str()) != MeshImporter::Format_Unknown)
+        *result = SceneObject::loadFromMesh(fileName.c_str(), &progress);
+    else
+        *result = SceneObject::loadFromText(fileName.c_str(), &progress);
 
-    if (fractionalDigits > numberOfFractionDigits)
-        numberOfFractionDigits = fractionalDigits;
-}
+    if (!*result)
+        return false;
 
-Z decimalToZ(const QDecimal &decimal)
-{
-    QByteArray buffer = decimal.toString();
+    (*result)->setRotating(rotating);
 
-    int dotIndex = buffer.indexOf('.');
+    // every triangle costs predicates against all triangles of the other set
+    (*result)->cleanUp(mergeCoplanar);
 
-    if (dotIndex != -1)
-        buffer[dotIndex] = '\0';
-    else
-        buffer.append('\0');
+    // the view needs it at once, so build it here rather than on the GUI thread
+    (*result)->doubleGeometry();
+    return true;
+}
 
-    Z result;
-    string_to_bigint(buffer.data(), result);
-    return result;
+bool loadSphereTreeTask(const std::string &fileName, bool normalize, boost::shared_ptr<SphereTreeLoader> loader, ImportProgress &progress)
+{
+    return loader->loadFromFile(fileName.c_str(), normalize, &progress);
 }
 
-//const int MOTION_ANIMATION_TIME = 5000;
-const int MAXIMUM_EXACT_TRUNCATION_DIGITS = 32;
+// calibration task, runs whole libcs cell builds on a worker
+bool calibrateTask(boost::shared_ptr<NeighbourCollectProfile> profile, ImportProgress &progress)
+{
+    return profile->calibrate(&progress);
+}
 } // namespace anonymous
 
+// everything read from an arr file
+struct ClientForm::ArrScene
+{
+    std::vector<SceneObjectPtr> sceneObjects;
+
+    double beginYaw, beginPitch, beginRoll;
+    double endYaw, endPitch, endRoll;
+};
+
 ClientForm::ClientForm(QWidget *parent) :
     QWidget(parent),
+    m_sceneVersion(0),
     m_configurationObjectPopupRow(-1),
+    m_sceneImport(new TaskRunner(this)),
+    m_sceneImportDialog(0),
+    m_calibration(new TaskRunner(this)),
+    m_calibrationDialog(0),
     m_motionTimer(0),
     ui(new Ui::ClientForm)
 {
@@ -154,6 +186,12 @@ ClientForm::ClientForm(QWidget *parent) :
 
     ui->toolButtonConvert->setMenu(toolButtonMenu);
 
+    // background scene loading
+    connect(m_sceneImport, SIGNAL(finished(bool,bool)), this, SLOT(sceneImportFinished(bool,bool)));
+
+    // background neighbour collect calibration
+    connect(m_calibration, SIGNAL(finished(bool,bool)), this, SLOT(calibrationFinished(bool,bool)));
+
     // attach to logger
     connect(QLog4cxx::instance(), SIGNAL(logMessage(QString,QString,long long,QString)), this, SLOT(logMessage(QString,QString,long long,QString)));
 }
@@ -245,8 +283,8 @@ size_t ClientForm::selectRasterResolution()
                                          QObject::tr("Select resolution"),
                                          QObject::tr("Select raster resolution"),
                                          128,
-                                         1,
-                                         256,
+                                         MINIMUM_RASTER_RESOLUTION,
+                                         MAXIMUM_RASTER_RESOLUTION,
                                          1,
                                          &ok));
 
@@ -277,6 +315,72 @@ size_t ClientForm::selectCellSampleCount()
     return sampleCount;
 }
 
+int ClientForm::selectCellNeighbourCollectAlgorithm(size_t sampleCount)
+{
+    // explicit choice
+    int algorithm = ui->comboBoxCellNeighbourCollectAlgorithm->currentIndex();
+
+    if (algorithm)
+        return algorithm;
+
+    // fastest measured on this host
+    double cost;
+    algorithm = NeighbourCollectProfile::load().fastest(sampleCount, &cost);
+
+    if (!algorithm)
+    {
+        LOG4CXX_INFO(g_logger, "Neighbour collect: no calibration profile, using the optimal algorithm");
+        return NeighbourCollectProfile::NUMBER_OF_ALGORITHMS;
+    }
+
+    LOG4CXX_INFO(g_logger, "Neighbour collect: " << NeighbourCollectProfile::algorithmName(algorithm)
+                 << " algorithm, expected " << cost << " s for " << sampleCount << " samples");
+
+    return algorithm;
+}
+
+void ClientForm::on_pushButtonCalibrateCellNeighbourCollect_clicked()
+{
+    CalibrationResult profile(new NeighbourCollectProfile());
+
+    std::vector<TaskRunner::Task> tasks;
+    tasks.push_back(boost::bind(&calibrateTask, profile, _1));
+
+    if (!m_calibration->start(tasks, boost::bind(&ClientForm::finishCalibration, this, profile)))
+        return (void)QMessageBox::warning(this, tr("Calibrate"), tr("Calibration is still running!"), QMessageBox::Ok);
+
+    // builds select the algorithm globally, so nothing else may run meanwhile
+    m_calibrationDialog = new QProgressDialog(tr("Calibrating..."), tr("Cancel"), 0, ImportProgress::MAXIMUM, this);
+    m_calibrationDialog->setWindowTitle(tr("Calibrate"));
+    m_calibrationDialog->setWindowModality(Qt::WindowModal);
+    m_calibrationDialog->setMinimumDuration(0);
+    m_calibrationDialog->setAutoClose(false);
+    m_calibrationDialog->setAutoReset(false);
+
+    connect(m_calibration, SIGNAL(progressChanged(int)), m_calibrationDialog, SLOT(setValue(int)));
+    connect(m_calibrationDialog, SIGNAL(canceled()), m_calibration, SLOT(cancel()));
+}
+
+void ClientForm::calibrationFinished(bool succeeded, bool cancelled)
+{
+    if (m_calibrationDialog)
+    {
+        m_calibrationDialog->deleteLater();
+        m_calibrationDialog = 0;
+    }
+
+    // a cancelled calibration keeps the stored profile
+    if (!succeeded && !cancelled)
+        QMessageBox::warning(this, tr("Calibrate"), tr("Failed to calibrate neighbour collect algorithms!"), QMessageBox::Ok);
+}
+
+void ClientForm::finishCalibration(CalibrationResult profile)
+{
+    profile->save();
+
+    QMessageBox::information(this, tr("Calibrate"), tr("Neighbour collect algorithms calibrated"), QMessageBox::Ok);
+}
+
 void ClientForm::on_toolButtonSceneCameraArcBall_clicked()
 {
     setSceneCamera(CT_ArcBall);
@@ -320,20 +424,80 @@ void ClientForm::on_toolButtonOpenSceneSph_clicked()
     if (fileName.isEmpty())
         return;
 
-    SceneObjectPtr object = SceneObject::loadFromSphereTree(fileName.toStdString().c_str(), this);
+    // renormalization
+    bool normalize = QMessageBox::question(this,
+                                           tr("Normalize sphere tree"),
+                                           tr("Do you want to normalize sphere tree to unit box?"),
+                                           QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes;
+
+    SphereTreeResult loader(new SphereTreeLoader());
+
+    std::vector<TaskRunner::Task> tasks;
+    tasks.push_back(boost::bind(&loadSphereTreeTask, fileName.toStdString(), normalize, loader, _1));
+
+    startSceneImport(tr("Open sphere tree"), tasks, boost::bind(&ClientForm::finishSphereTreeImport, this, loader, fileName));
+}
+
+void ClientForm::finishSphereTreeImport(SphereTreeResult loader, const QString &fileName)
+{
+    // choose level
+    bool ok = false;
+
+    int level = QInputDialog::getInt(this,
+                                     tr("Select sphere tree level"),
+                                     tr("Select level"),
+                                     static_cast<int>(loader->numberOfLevels()) - 1,
+                                     0,
+                                     static_cast<int>(loader->numberOfLevels()) - 1,
+                                     1,
+                                     &ok);
+
+    if (!ok)
+        return;
 
-    if (!object)
-        return (void)QMessageBox::warning(this, tr("Open file"), tr("Failed to load file!"), QMessageBox::Ok);
+    SceneObjectPtr object = SceneObject::loadFromSphereTree(*loader, static_cast<size_t>(level));
 
     // register
     object->setColor(m_widgetSceneView->nextSuggestedColor());
-    addSceneObject(object, fileName.toStdString().c_str());
+    addSceneObject(object, fileName);
+}
+
+void ClientForm::startSceneImport(const QString &title, const std::vector<TaskRunner::Task> &tasks, const TaskRunner::Finish &finish)
+{
+    if (!m_sceneImport->start(tasks, finish))
+        return (void)QMessageBox::warning(this, title, tr("Another scene is still loading!"), QMessageBox::Ok);
+
+    m_sceneImportTitle = title;
+
+    // the view stays live, but the scene cannot be edited until the import ends
+    m_sceneImportDialog = new QProgressDialog(tr("Loading..."), tr("Cancel"), 0, ImportProgress::MAXIMUM, this);
+    m_sceneImportDialog->setWindowTitle(title);
+    m_sceneImportDialog->setWindowModality(Qt::WindowModal);
+    m_sceneImportDialog->setMinimumDuration(SCENE_IMPORT_DIALOG_DELAY);
+    m_sceneImportDialog->setAutoClose(false);
+    m_sceneImportDialog->setAutoReset(false);
+
+    connect(m_sceneImport, SIGNAL(progressChanged(int)), m_sceneImportDialog, SLOT(setValue(int)));
+    connect(m_sceneImportDialog, SIGNAL(canceled()), m_sceneImport, SLOT(cancel()));
+}
+
+void ClientForm::sceneImportFinished(bool succeeded, bool cancelled)
+{
+    if (m_sceneImportDialog)
+    {
+        m_sceneImportDialog->deleteLater();
+        m_sceneImportDialog = 0;
+    }
+
+    if (!succeeded && !cancelled)
+        QMessageBox::warning(this, m_sceneImportTitle, tr("Failed to load scene!"), QMessageBox::Ok);
 }
 
 void ClientForm::addSceneObject(SceneObjectPtr object, const QString &fileName)
 {
     // register object
     m_sceneObjects.push_back(object);
+    invalidateSceneSnapshot();
 
     // icon
     QIcon icon;
@@ -344,13 +508,13 @@ void ClientForm::addSceneObject(SceneObjectPtr object, const QString &fileName)
     switch (object->type())
     {
     case SceneObject::Type_DecimalBallList:
-        m_widgetSceneView->addDecimalBallList(object->decimalBallList(), object->color());
+        m_widgetSceneView->addDecimalBallList(object->decimalBallList(), object->doubleGeometry(), object->color());
         icon = QIcon(":/resource/img/ball.png");
         info = QString("file: %1, balls: %2").arg(QFileInfo(fileName).fileName(), QString::number(object->decimalBallList()->size()));
         break;
 
     case SceneObject::Type_DecimalTriangleList:
-        m_widgetSceneView->addDecimalTriangleList(object->decimalTriangleList(), object->color());
+        m_widgetSceneView->addDecimalTriangleList(object->decimalTriangleList(), object->doubleGeometry(), object->color());
         icon = QIcon(":/resource/img/tritri.png");
         info = QString("file: %1, triangles: %2").arg(QFileInfo(fileName).fileName(), QString::number(object->decimalTriangleList()->size()));
         break;
@@ -450,17 +614,25 @@ void ClientForm::on_toolButtonOpenSceneDir_clicked()
     if (directory.isEmpty())
         return;
 
-    std::pair<SceneObjectPtr, SceneObjectPtr> objects = SceneObject::loadFromDirectory(directory.toStdString().c_str(), this);
+    // robot and obstacle load concurrently
+    SceneObjectResult robot(new SceneObjectPtr());
+    SceneObjectResult obstacle(new SceneObjectPtr());
+
+    std::vector<TaskRunner::Task> tasks;
+    tasks.push_back(boost::bind(&loadTextTask, QDir(directory).filePath("robot.txt").toStdString(), true, ui->checkBoxSceneMergeCoplanarFaces->isChecked(), robot, _1));
+    tasks.push_back(boost::bind(&loadTextTask, QDir(directory).filePath("obstacle.txt").toStdString(), false, ui->checkBoxSceneMergeCoplanarFaces->isChecked(), obstacle, _1));
 
-    if (!objects.first || !objects.second)
-        return (void)QMessageBox::warning(this, tr("Open directory"), tr("Failed to load directory!"), QMessageBox::Ok);
+    startSceneImport(tr("Open directory"), tasks, boost::bind(&ClientForm::finishDirectoryImport, this, robot, obstacle, directory));
+}
 
+void ClientForm::finishDirectoryImport(SceneObjectResult robot, SceneObjectResult obstacle, const QString &directory)
+{
     // register
-    objects.first->setColor(m_widgetSceneView->nextSuggestedColor());
-    addSceneObject(objects.first, directory.toStdString().c_str());
+    (*robot)->setColor(m_widgetSceneView->nextSuggestedColor());
+    addSceneObject(*robot, directory);
 
-    objects.second->setColor(m_widgetSceneView->nextSuggestedColor());
-    addSceneObject(objects.second, directory.toStdString().c_str());
+    (*obstacle)->setColor(m_widgetSceneView->nextSuggestedColor());
+    addSceneObject(*obstacle, directory);
 }
 
 void ClientForm::on_labelSceneObjectDelete_linkActivated(const QString &link)
@@ -508,6 +680,7 @@ void ClientForm::removeSceneObject(int row)
 
     // remove from model
     m_sceneObjects.erase(m_sceneObjects.begin() + row);
+    invalidateSceneSnapshot();
 }
 
 void ClientForm::removeConfigurationObject(int row)
@@ -630,6 +803,32 @@ void ClientForm::convertToExactGraphTriggered()
     createExactConfigurationSpace(type);
 }
 
+SceneSnapshotPtr ClientForm::sceneSnapshot(SceneObject::Type type)
+{
+    // the snapshot is rebuilt only after the scene has changed
+    if (!m_sceneSnapshot || m_sceneSnapshot->version() != m_sceneVersion || m_sceneSnapshot->type() != type)
+        m_sceneSnapshot.reset(new SceneSnapshot(m_sceneObjects, type, m_sceneVersion));
+
+    return m_sceneSnapshot;
+}
+
+void ClientForm::invalidateSceneSnapshot()
+{
+    ++m_sceneVersion;
+    m_sceneSnapshot.reset();
+}
+
+bool ClientForm::checkSceneSnapshot(SceneSnapshotPtr snapshot)
+{
+    if (!snapshot->numberOfMovable() || !snapshot->numberOfObstacles())
+    {
+        QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
+        return false;
+    }
+
+    return true;
+}
+
 void ClientForm::createRasterConfigurationSpace(SceneObject::Type type, VolumeRendererType volumeRendererType)
 {
     // Note:
@@ -637,110 +836,40 @@ void ClientForm::createRasterConfigurationSpace(SceneObject::Type type, VolumeRe
     // scenes for an inexact kernel over R (double)
     RasterConfigurationSpacePtr rasterConfigurationSpace;
 
-    // create scene
+    SceneSnapshotPtr snapshot = sceneSnapshot(type);
+
+    if (!checkSceneSnapshot(snapshot))
+        return;
+
+    // get raster resolution
+    size_t resolution = selectRasterResolution();
+
+    if (!resolution)
+        return;
+
+    // create raster
     switch (type)
     {
     case SceneObject::Type_DecimalBallList:
-        {
-            Ball_list_3_R movable;
-            Ball_list_3_R obstacle;
-            Ball_list_3_R *target;
-
-            // accumulate scene and rotating object
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin();
-                 sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                if ((*sceneObjectIterator)->isRotating())
-                    target = &movable;
-                else
-                    target = &obstacle;
-
-                for (DecimalBallList::const_iterator ballIterator = (*sceneObjectIterator)->decimalBallList()->begin();
-                     ballIterator != (*sceneObjectIterator)->decimalBallList()->end(); ++ballIterator)
-                {
-                    target->push_back(Ball_3_R(Vector_3_R(ballIterator->center().x().toDouble(),
-                                                          ballIterator->center().y().toDouble(),
-                                                          ballIterator->center().z().toDouble()),
-                                               ballIterator->radius().toDouble()));
-                }
-            }
-
-            if (movable.empty() || obstacle.empty())
-            {
-                QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
-                return;
-            }
-
-            // get raster resolution
-            size_t resolution = selectRasterResolution();
-
-            if (!resolution)
-                return;
-
-            // create raster
-            rasterConfigurationSpace.reset(
-                new RasterConfigurationSpace(
-                    RasterConfigurationSpaceTag<Spin_configuration_space_3::Raster_BB_R>(),
-                    movable.begin(), movable.end(),
-                    obstacle.begin(), obstacle.end(),
-                    Spin_configuration_space_3::Raster_BB_R::Parameters(resolution),
-                    volumeRendererType,
-                    m_widgetConfigurationView));
-        }
+        rasterConfigurationSpace.reset(
+            new RasterConfigurationSpace(
+                RasterConfigurationSpaceTag<Spin_configuration_space_3::Raster_BB_R>(),
+                snapshot->movableBallsR().begin(), snapshot->movableBallsR().end(),
+                snapshot->obstacleBallsR().begin(), snapshot->obstacleBallsR().end(),
+                Spin_configuration_space_3::Raster_BB_R::Parameters(resolution),
+                volumeRendererType,
+                m_widgetConfigurationView));
         break;
 
     case SceneObject::Type_DecimalTriangleList:
-        {
-            Triangle_list_3_R movable;
-            Triangle_list_3_R obstacle;
-            Triangle_list_3_R *target;
-
-            // accumulate scene and rotating object
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin();
-                 sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                if ((*sceneObjectIterator)->isRotating())
-                    target = &movable;
-                else
-                    target = &obstacle;
-
-                for (DecimalTriangleList::const_iterator triangleIterator = (*sceneObjectIterator)->decimalTriangleList()->begin();
-                     triangleIterator != (*sceneObjectIterator)->decimalTriangleList()->end(); ++triangleIterator)
-                {
-                    target->push_back(Triangle_3_R(Point_3_R(triangleIterator->vertex(0).x().toDouble(),
-                                                             triangleIterator->vertex(0).y().toDouble(),
-                                                             triangleIterator->vertex(0).z().toDouble()),
-                                                   Point_3_R(triangleIterator->vertex(1).x().toDouble(),
-                                                             triangleIterator->vertex(1).y().toDouble(),
-                                                             triangleIterator->vertex(1).z().toDouble()),
-                                                   Point_3_R(triangleIterator->vertex(2).x().toDouble(),
-                                                             triangleIterator->vertex(2).y().toDouble(),
-                                                             triangleIterator->vertex(2).z().toDouble())));
-                }
-            }
-
-            if (movable.empty() || obstacle.empty())
-            {
-                QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
-                return;
-            }
-
-            // get raster resolution
-            size_t resolution = selectRasterResolution();
-
-            if (!resolution)
-                return;
-
-            // create raster
-            rasterConfigurationSpace.reset(
-                new RasterConfigurationSpace(
-                    RasterConfigurationSpaceTag<Spin_configuration_space_3::Raster_TT_R>(),
-                    movable.begin(), movable.end(),
-                    obstacle.begin(), obstacle.end(),
-                    Spin_configuration_space_3::Raster_TT_R::Parameters(resolution),
-                    volumeRendererType,
-                    m_widgetConfigurationView));
-        }
+        rasterConfigurationSpace.reset(
+            new RasterConfigurationSpace(
+                RasterConfigurationSpaceTag<Spin_configuration_space_3::Raster_TT_R>(),
+                snapshot->movableTrianglesR().begin(), snapshot->movableTrianglesR().end(),
+                snapshot->obstacleTrianglesR().begin(), snapshot->obstacleTrianglesR().end(),
+                Spin_configuration_space_3::Raster_TT_R::Parameters(resolution),
+                volumeRendererType,
+                m_widgetConfigurationView));
         break;
     }
 
@@ -756,111 +885,41 @@ void ClientForm::createCellConfigurationSpace(SceneObject::Type type)
     // scenes for an inexact kernel over R (double)
     CellConfigurationSpacePtr cellConfigurationSpace;
 
-    // create scene
+    SceneSnapshotPtr snapshot = sceneSnapshot(type);
+
+    if (!checkSceneSnapshot(snapshot))
+        return;
+
+    // get sample count
+    size_t sampleCount = selectCellSampleCount();
+
+    if (!sampleCount)
+        return;
+
+    // setup libcs config for cell graph
+    CS::Config::set_neighbour_collect_algorithm(selectCellNeighbourCollectAlgorithm(sampleCount));
+
+    // create cell graph
     switch (type)
     {
     case SceneObject::Type_DecimalBallList:
-        {
-            Ball_list_3_R movable;
-            Ball_list_3_R obstacle;
-            Ball_list_3_R *target;
-
-            // accumulate scene and rotating object
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin();
-                 sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                if ((*sceneObjectIterator)->isRotating())
-                    target = &movable;
-                else
-                    target = &obstacle;
-
-                for (DecimalBallList::const_iterator ballIterator = (*sceneObjectIterator)->decimalBallList()->begin();
-                     ballIterator != (*sceneObjectIterator)->decimalBallList()->end(); ++ballIterator)
-                {
-                    target->push_back(Ball_3_R(Vector_3_R(ballIterator->center().x().toDouble(),
-                                                          ballIterator->center().y().toDouble(),
-                                                          ballIterator->center().z().toDouble()),
-                                               ballIterator->radius().toDouble()));
-                }
-            }
-
-            if (movable.empty() || obstacle.empty())
-            {
-                QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
-                return;
-            }
-
-            // get raster resolution
-            size_t sampleCount = selectCellSampleCount();
-
-            if (!sampleCount)
-                return;
-
-            // setup libcs config for cell graph
-            CS::Config::set_neighbour_collect_algorithm(ui->comboBoxCellNeighbourCollectAlgorithm->currentIndex() + 1);
-
-            // create raster
-            cellConfigurationSpace.reset(
-                new CellConfigurationSpace(
-                    CellConfigurationSpaceTag<Spin_configuration_space_3::Cell_BB_R>(),
-                    movable.begin(), movable.end(),
-                    obstacle.begin(), obstacle.end(),
-                    Spin_configuration_space_3::Cell_BB_R::Parameters(sampleCount),
-                    m_widgetConfigurationView));
-        }
+        cellConfigurationSpace.reset(
+            new CellConfigurationSpace(
+                CellConfigurationSpaceTag<Spin_configuration_space_3::Cell_BB_R>(),
+                snapshot->movableBallsR().begin(), snapshot->movableBallsR().end(),
+                snapshot->obstacleBallsR().begin(), snapshot->obstacleBallsR().end(),
+                Spin_configuration_space_3::Cell_BB_R::Parameters(sampleCount),
+                m_widgetConfigurationView));
         break;
 
     case SceneObject::Type_DecimalTriangleList:
-        {
-            Triangle_list_3_R movable;
-            Triangle_list_3_R obstacle;
-            Triangle_list_3_R *target;
-
-            // accumulate scene and rotating object
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin();
-                 sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                if ((*sceneObjectIterator)->isRotating())
-                    target = &movable;
-                else
-                    target = &obstacle;
-
-                for (DecimalTriangleList::const_iterator triangleIterator = (*sceneObjectIterator)->decimalTriangleList()->begin();
-                     triangleIterator != (*sceneObjectIterator)->decimalTriangleList()->end(); ++triangleIterator)
-                {
-                    target->push_back(Triangle_3_R(Point_3_R(triangleIterator->vertex(0).x().toDouble(),
-                                                             triangleIterator->vertex(0).y().toDouble(),
-                                                             triangleIterator->vertex(0).z().toDouble()),
-                                                   Point_3_R(triangleIterator->vertex(1).x().toDouble(),
-                                                             triangleIterator->vertex(1).y().toDouble(),
-                                                             triangleIterator->vertex(1).z().toDouble()),
-                                                   Point_3_R(triangleIterator->vertex(2).x().toDouble(),
-                                                             triangleIterator->vertex(2).y().toDouble(),
-                                                             triangleIterator->vertex(2).z().toDouble())));
-                }
-            }
-
-            if (movable.empty() || obstacle.empty())
-            {
-                QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
-                return;
-            }
-
-            // get raster resolution
-            size_t sampleCount = selectCellSampleCount();
-
-            if (!sampleCount)
-                return;
-
-            // create raster
-            cellConfigurationSpace.reset(
-                new CellConfigurationSpace(
-                    CellConfigurationSpaceTag<Spin_configuration_space_3::Cell_TT_R>(),
-                    movable.begin(), movable.end(),
-                    obstacle.begin(), obstacle.end(),
-                    Spin_configuration_space_3::Cell_TT_R::Parameters(sampleCount),
-                    m_widgetConfigurationView));
-        }
+        cellConfigurationSpace.reset(
+            new CellConfigurationSpace(
+                CellConfigurationSpaceTag<Spin_configuration_space_3::Cell_TT_R>(),
+                snapshot->movableTrianglesR().begin(), snapshot->movableTrianglesR().end(),
+                snapshot->obstacleTrianglesR().begin(), snapshot->obstacleTrianglesR().end(),
+                Spin_configuration_space_3::Cell_TT_R::Parameters(sampleCount),
+                m_widgetConfigurationView));
         break;
     }
 
@@ -883,172 +942,81 @@ void ClientForm::createExactConfigurationSpace(SceneObject::Type type)
     // options
     bool optionViewClipPlane = ui->checkBoxOptionViewClipPlane->isChecked();
 
+    // budget, zero means no limit
+    double timeBudget = ui->spinBoxMeshingTimeBudget->value();
+    size_t memoryBudget = static_cast<size_t>(ui->spinBoxMeshingMemoryBudget->value()) << 20;
+
     // Note:
     // for the exact scenes, we will use triangulated or ball-only
     // scenes for an EXACT kernel over Z
     ExactConfigurationSpacePtr exactConfigurationSpace;
 
-    // find a common scene denominator to convert it to Z
-    int maximumNumberOfFractionDigits = 0;
-
-    switch (type)
-    {
-    case SceneObject::Type_DecimalBallList:
-        {
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin();
-                 sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                for (DecimalBallList::const_iterator ballIterator = (*sceneObjectIterator)->decimalBallList()->begin();
-                     ballIterator != (*sceneObjectIterator)->decimalBallList()->end(); ++ballIterator)
-                {
-                    updateMaximumFractionDigits(maximumNumberOfFractionDigits, ballIterator->center().x());
-                    updateMaximumFractionDigits(maximumNumberOfFractionDigits, ballIterator->center().y());
-                    updateMaximumFractionDigits(maximumNumberOfFractionDigits, ballIterator->center().z());
-                    updateMaximumFractionDigits(maximumNumberOfFractionDigits, ballIterator->radius());
-                }
-            }
-        }
-        break;
+    SceneSnapshotPtr snapshot = sceneSnapshot(type);
 
-    case SceneObject::Type_DecimalTriangleList:
-        {
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin(); sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                for (DecimalTriangleList::const_iterator triangleIterator = (*sceneObjectIterator)->decimalTriangleList()->begin();
-                     triangleIterator != (*sceneObjectIterator)->decimalTriangleList()->end(); ++triangleIterator)
-                {
-                    for (int v = 0; v < 3; ++v)
-                    {
-                        updateMaximumFractionDigits(maximumNumberOfFractionDigits, triangleIterator->vertex(v).x());
-                        updateMaximumFractionDigits(maximumNumberOfFractionDigits, triangleIterator->vertex(v).y());
-                        updateMaximumFractionDigits(maximumNumberOfFractionDigits, triangleIterator->vertex(v).z());
-                    }
-                }
-            }
-        }
-        break;
-    }
+    if (!checkSceneSnapshot(snapshot))
+        return;
 
-    // generate scele factor
-    if (maximumNumberOfFractionDigits > MAXIMUM_EXACT_TRUNCATION_DIGITS)
+    // the exact geometry is converted here on first use
+    if (snapshot->isExactTruncated())
     {
         QMessageBox::warning(this,
                              tr("Floating-point scene"),
                              tr("Some of the coordinates have more than 32 significant fraction digits!\nTruncation is going to occur!"), QMessageBox::Ok);
-
-        maximumNumberOfFractionDigits = MAXIMUM_EXACT_TRUNCATION_DIGITS;
     }
 
-    QDecimal scaleFactor(1);
+    // meshed primitives are checkpointed per scene and keyed by their own
+    // content, so an interrupted or staged build resumes from there
+    std::string buildKey = snapshot->hash() + (type == SceneObject::Type_DecimalBallList ? "-bb" : "-tt");
+
+    ExactCheckpointPtr checkpoint(new ExactCheckpoint(buildKey));
 
-    for (int j = 0 ; j < maximumNumberOfFractionDigits; ++j)
-        scaleFactor *= 10;
+    // the budget clock includes the exact computation; without limits the
+    // coarse meshes are built at once and a failed one is reported
+    MeshingBudgetPtr budget;
 
-    // create scene
+    if (timeBudget > 0 || memoryBudget > 0)
+        budget.reset(new MeshingBudget(timeBudget, memoryBudget));
+
+    // create exact configuration space
     switch (type)
     {
     case SceneObject::Type_DecimalBallList:
-        {
-            Ball_list_3_Z movable;
-            Ball_list_3_Z obstacle;
-            Ball_list_3_Z *target;
-
-            // accumulate scene and rotating object
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin(); sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                if ((*sceneObjectIterator)->isRotating())
-                    target = &movable;
-                else
-                    target = &obstacle;
-
-                for (DecimalBallList::const_iterator ballIterator = (*sceneObjectIterator)->decimalBallList()->begin();
-                     ballIterator != (*sceneObjectIterator)->decimalBallList()->end(); ++ballIterator)
-                {
-                    Z x = decimalToZ(scaleFactor * ballIterator->center().x());
-                    Z y = decimalToZ(scaleFactor * ballIterator->center().y());
-                    Z z = decimalToZ(scaleFactor * ballIterator->center().z());
-                    Z r = decimalToZ(scaleFactor * ballIterator->radius());
-
-                    target->push_back(Ball_3_Z(Vector_3_Z(x, y, z), r));
-                }
-            }
-
-            if (movable.empty() || obstacle.empty())
-            {
-                QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
-                return;
-            }
-
-            // create raster
-            exactConfigurationSpace.reset(
-                new ExactConfigurationSpace(
-                    ExactConfigurationSpaceTag<Spin_configuration_space_3::Exact_BB_Z>(),
-                    movable.begin(), movable.end(),
-                    obstacle.begin(), obstacle.end(),
-                    Spin_configuration_space_3::Exact_BB_Z::Parameters(suppressQsicCalculation, suppressQsipCalculation),
-                    suppressQuadricMeshing,
-                    suppressQsicMeshing,
-                    suppressQsipMeshing,
-                    optionViewClipPlane,
-                    m_widgetConfigurationView));
-        }
+        exactConfigurationSpace.reset(
+            new ExactConfigurationSpace(
+                ExactConfigurationSpaceTag<Spin_configuration_space_3::Exact_BB_Z>(),
+                snapshot->movableBallsZ().begin(), snapshot->movableBallsZ().end(),
+                snapshot->obstacleBallsZ().begin(), snapshot->obstacleBallsZ().end(),
+                Spin_configuration_space_3::Exact_BB_Z::Parameters(suppressQsicCalculation, suppressQsipCalculation),
+                suppressQuadricMeshing,
+                suppressQsicMeshing,
+                suppressQsipMeshing,
+                optionViewClipPlane,
+                checkpoint,
+                budget,
+                m_widgetConfigurationView));
         break;
 
     case SceneObject::Type_DecimalTriangleList:
-        {
-            Triangle_list_3_Z movable;
-            Triangle_list_3_Z obstacle;
-            Triangle_list_3_Z *target;
-
-            // accumulate scene and rotating object
-            for (SceneObjects::const_iterator sceneObjectIterator = m_sceneObjects.begin(); sceneObjectIterator != m_sceneObjects.end(); ++sceneObjectIterator)
-            {
-                if ((*sceneObjectIterator)->isRotating())
-                    target = &movable;
-                else
-                    target = &obstacle;
-
-                for (DecimalTriangleList::const_iterator triangleIterator = (*sceneObjectIterator)->decimalTriangleList()->begin();
-                     triangleIterator != (*sceneObjectIterator)->decimalTriangleList()->end(); ++triangleIterator)
-                {
-                    Z x0 = decimalToZ(scaleFactor * triangleIterator->vertex(0).x());
-                    Z y0 = decimalToZ(scaleFactor * triangleIterator->vertex(0).y());
-                    Z z0 = decimalToZ(scaleFactor * triangleIterator->vertex(0).z());
-                    Z x1 = decimalToZ(scaleFactor * triangleIterator->vertex(1).x());
-                    Z y1 = decimalToZ(scaleFactor * triangleIterator->vertex(1).y());
-                    Z z1 = decimalToZ(scaleFactor * triangleIterator->vertex(1).z());
-                    Z x2 = decimalToZ(scaleFactor * triangleIterator->vertex(2).x());
-                    Z y2 = decimalToZ(scaleFactor * triangleIterator->vertex(2).y());
-                    Z z2 = decimalToZ(scaleFactor * triangleIterator->vertex(2).z());
-
-                    target->push_back(Triangle_3_Z(Point_3_Z(x0, y0, z0),
-                                                   Point_3_Z(x1, y1, z1),
-                                                   Point_3_Z(x2, y2, z2)));
-                }
-            }
-
-            if (movable.empty() || obstacle.empty())
-            {
-                QMessageBox::warning(this, tr("Invalid scene"), tr("Neither movable nor obstacles can be empty!"), QMessageBox::Ok);
-                return;
-            }
-
-            // create raster
-            exactConfigurationSpace.reset(
-                new ExactConfigurationSpace(
-                    ExactConfigurationSpaceTag<Spin_configuration_space_3::Exact_TT_Z>(),
-                    movable.begin(), movable.end(),
-                    obstacle.begin(), obstacle.end(),
-                    Spin_configuration_space_3::Exact_TT_Z::Parameters(suppressQsicCalculation, suppressQsipCalculation),
-                    suppressQuadricMeshing,
-                    suppressQsicMeshing,
-                    suppressQsipMeshing,
-                    optionViewClipPlane,
-                    m_widgetConfigurationView));
-        }
+        exactConfigurationSpace.reset(
+            new ExactConfigurationSpace(
+                ExactConfigurationSpaceTag<Spin_configuration_space_3::Exact_TT_Z>(),
+                snapshot->movableTrianglesZ().begin(), snapshot->movableTrianglesZ().end(),
+                snapshot->obstacleTrianglesZ().begin(), snapshot->obstacleTrianglesZ().end(),
+                Spin_configuration_space_3::Exact_TT_Z::Parameters(suppressQsicCalculation, suppressQsipCalculation),
+                suppressQuadricMeshing,
+                suppressQsicMeshing,
+                suppressQsipMeshing,
+                optionViewClipPlane,
+                checkpoint,
+                budget,
+                m_widgetConfigurationView));
         break;
     }
 
+    // refine along the current motion first
+    if (RoutePtr route = selectedRoute())
+        exactConfigurationSpace->setFocusRoute(route);
+
     // add configuration space to view
     ConfigurationObjectPtr configurationObject(new ConfigurationObject(exactConfigurationSpace));
     addConfigurationObject(configurationObject, "<generated>", QIcon(":/resource/img/recalculate.png"));
@@ -1078,6 +1046,9 @@ void ClientForm::on_tableWidgetSceneObjects_cellDoubleClicked(int row, int colum
     sceneObject->setRotating(dialog.isObjectRotating());
     sceneObject->setColor(dialog.objectColor());
 
+    // movable and obstacle sets may have changed
+    invalidateSceneSnapshot();
+
     switch (sceneObject->type())
     {
     case SceneObject::Type_DecimalBallList:
@@ -1149,19 +1120,24 @@ void ClientForm::on_toolButtonOpenSceneTxt_clicked()
             this,
             tr("Open triangulated mesh"),
             QString(),
-            tr("Triangulated mesh files (*.txt)"));
+            tr("Triangulated mesh files (*.txt *.stl *.ply *.obj)"));
 
     if (fileName.isEmpty())
         return;
 
-    SceneObjectPtr object = SceneObject::loadFromText(fileName.toStdString().c_str(), this);
+    SceneObjectResult object(new SceneObjectPtr());
 
-    if (!object)
-        return (void)QMessageBox::warning(this, tr("Open file"), tr("Failed to load file!"), QMessageBox::Ok);
+    std::vector<TaskRunner::Task> tasks;
+    tasks.push_back(boost::bind(&loadTextTask, fileName.toStdString(), false, ui->checkBoxSceneMergeCoplanarFaces->isChecked(), object, _1));
 
+    startSceneImport(tr("Open file"), tasks, boost::bind(&ClientForm::finishTextImport, this, object, fileName));
+}
+
+void ClientForm::finishTextImport(SceneObjectResult object, const QString &fileName)
+{
     // register
-    object->setColor(m_widgetSceneView->nextSuggestedColor());
-    addSceneObject(object, fileName.toStdString().c_str());
+    (*object)->setColor(m_widgetSceneView->nextSuggestedColor());
+    addSceneObject(*object, fileName);
 }
 
 void ClientForm::on_checkBoxSceneRenderingWireframe_toggled(bool checked)
@@ -1310,6 +1286,10 @@ void ClientForm::routeConfigurationObjectTriggered()
     // if a route was found add it to configuration view
     if (route)
     {
+        // refine an exact configuration space along the route first
+        if (configurationObject->type() == ConfigurationObject::Type_ExactConfigurationSpace)
+            configurationObject->exactConfigurationSpace()->setFocusRoute(route);
+
         // add configuration object
         SampledRoutePtr sampledRoute(new SampledRoute(route, m_widgetConfigurationView));
         ConfigurationObjectPtr configurationObject(new ConfigurationObject(route, sampledRoute));
@@ -1579,6 +1559,9 @@ void ClientForm::on_toolButtonSaveSceneArr_clicked()
         return;
 
     QDataStream dataStream(&file);
+    dataStream.setVersion(QDataStream::Qt_5_0);
+
+    dataStream << ARR_MAGIC << static_cast<quint32>(SceneObject::ArrVersion_Blocks);
 
     // scene objects
     dataStream << static_cast<int>(m_sceneObjects.size());
@@ -1609,75 +1592,109 @@ void ClientForm::on_toolButtonOpenSceneArr_clicked()
     if (fileName.isEmpty())
         return;
 
+    // the current scene is replaced only when the new one is complete
+    ArrSceneResult scene(new ArrScene());
+
+    std::vector<TaskRunner::Task> tasks;
+    tasks.push_back(boost::bind(&ClientForm::loadSceneFile, fileName, scene, _1));
+
+    startSceneImport(tr("Open scene"), tasks, boost::bind(&ClientForm::finishArrImport, this, scene));
+}
+
+void ClientForm::finishArrImport(ArrSceneResult scene)
+{
     // clear current scene
     while (!m_sceneObjects.empty())
         removeSceneObject(0);
 
+    for (std::vector<SceneObjectPtr>::const_iterator it = scene->sceneObjects.begin(); it != scene->sceneObjects.end(); ++it)
+        addSceneObject(*it, QString("<loaded>"));
+
+    ui->doubleSpinBoxMotionBeginYaw->setValue(scene->beginYaw);
+    ui->doubleSpinBoxMotionBeginPitch->setValue(scene->beginPitch);
+    ui->doubleSpinBoxMotionBeginRoll->setValue(scene->beginRoll);
+
+    ui->doubleSpinBoxMotionEndYaw->setValue(scene->endYaw);
+    ui->doubleSpinBoxMotionEndPitch->setValue(scene->endPitch);
+    ui->doubleSpinBoxMotionEndRoll->setValue(scene->endRoll);
+}
+
+bool ClientForm::loadSceneFile(const QString &fileName, ArrSceneResult scene, ImportProgress &progress)
+{
     // read all scene objects
     QFile file(fileName);
 
     if (!file.open(QFile::ReadOnly))
-        return;
+        return false;
 
     QDataStream dataStream(&file);
-
-    if (!readSceneFromStream(dataStream))
-    {
-        // clear partial read scene
-        while (!m_sceneObjects.empty())
-            removeSceneObject(0);
-
-        return (void)QMessageBox::warning(this, tr("Open scene"), tr("Failed to load scene!"), QMessageBox::Ok);
-    }
+    return readSceneFromStream(dataStream, *scene, progress);
 }
 
-bool ClientForm::readSceneFromStream(QDataStream &dataStream)
+bool ClientForm::readSceneFromStream(QDataStream &dataStream, ArrScene &scene, ImportProgress &progress)
 {
-    // scene objects
-    int numberOfSceneObjects;
+    // header or the object count of a version 1 file
+    quint32 magic;
 
-    dataStream >> numberOfSceneObjects;
+    dataStream >> magic;
     if (dataStream.status() != QDataStream::Ok) return false;
 
+    SceneObject::ArrVersion version = SceneObject::ArrVersion_Strings;
+    int numberOfSceneObjects = static_cast<int>(magic);
+
+    if (magic == ARR_MAGIC)
+    {
+        quint32 rawVersion;
+
+        dataStream.setVersion(QDataStream::Qt_5_0);
+
+        dataStream >> rawVersion;
+        if (dataStream.status() != QDataStream::Ok || rawVersion != static_cast<quint32>(SceneObject::ArrVersion_Blocks)) return false;
+
+        version = SceneObject::ArrVersion_Blocks;
+
+        dataStream >> numberOfSceneObjects;
+        if (dataStream.status() != QDataStream::Ok) return false;
+    }
+
+    // scene objects, progress follows the position in the file
+    qint64 size = std::max(qint64(1), dataStream.device()->size());
+
     for (int i = 0; i < numberOfSceneObjects; ++i)
     {
-        SceneObjectPtr sceneObject = SceneObject::loadFromStream(dataStream);
+        if (progress.isCancelled())
+            return false;
+
+        SceneObjectPtr sceneObject = SceneObject::loadFromStream(dataStream, version);
 
         if (!sceneObject)
             return false;
 
-        addSceneObject(sceneObject, QString("<loaded>"));
+        sceneObject->doubleGeometry();
+        scene.sceneObjects.push_back(sceneObject);
+
+        progress.setValue(static_cast<int>(ImportProgress::MAXIMUM * dataStream.device()->pos() / size));
     }
 
     // motion
-    double beginYaw, beginPitch, beginRoll, endYaw, endPitch, endRoll;
-
-    dataStream >> beginYaw;
+    dataStream >> scene.beginYaw;
     if (dataStream.status() != QDataStream::Ok) return false;
 
-    dataStream >> beginPitch;
+    dataStream >> scene.beginPitch;
     if (dataStream.status() != QDataStream::Ok) return false;
 
-    dataStream >> beginRoll;
+    dataStream >> scene.beginRoll;
     if (dataStream.status() != QDataStream::Ok) return false;
 
-    dataStream >> endYaw;
+    dataStream >> scene.endYaw;
     if (dataStream.status() != QDataStream::Ok) return false;
 
-    dataStream >> endPitch;
+    dataStream >> scene.endPitch;
     if (dataStream.status() != QDataStream::Ok) return false;
 
-    dataStream >> endRoll;
+    dataStream >> scene.endRoll;
     if (dataStream.status() != QDataStream::Ok) return false;
 
-    ui->doubleSpinBoxMotionBeginYaw->setValue(beginYaw);
-    ui->doubleSpinBoxMotionBeginPitch->setValue(beginPitch);
-    ui->doubleSpinBoxMotionBeginRoll->setValue(beginRoll);
-
-    ui->doubleSpinBoxMotionEndYaw->setValue(endYaw);
-    ui->doubleSpinBoxMotionEndPitch->setValue(endPitch);
-    ui->doubleSpinBoxMotionEndRoll->setValue(endRoll);
-
     return true;
 }
 
@@ -23,6 +23,8 @@
 #include "sceneobject.h"
 #include "configurationobject.h"
 #include "configurationspace.h"
+#include "scenesnapshot.h"
+#include "taskrunner.h"
 #include <QWidget>
 #include <QQuaternion>
 #include <QDataStream>
@@ -34,7 +36,10 @@ class ClientForm;
 
 class QTimer;
 class QTableWidgetItem;
+class QProgressDialog;
 class RenderView;
+class SphereTreeLoader;
+class NeighbourCollectProfile;
 
 class ClientForm : public QWidget
 {
@@ -57,6 +62,7 @@ private:
 
     size_t  selectRasterResolution();
     size_t  selectCellSampleCount();
+    int     selectCellNeighbourCollectAlgorithm(size_t sampleCount);
 
     enum MotionMode
     {
@@ -87,6 +93,9 @@ private slots:
     void saveConfigurationObjectTriggered();
     void routeConfigurationObjectTriggered();
 
+    void sceneImportFinished(bool succeeded, bool cancelled);
+    void calibrationFinished(bool succeeded, bool cancelled);
+
     void toggleSceneFullScreenTriggered();
     void toggleConfigurationFullScreenTriggered();
 
@@ -131,6 +140,7 @@ private slots:
     void on_toolButtonSaveSceneArr_clicked();
     void on_toolButtonOpenSceneArr_clicked();
     void on_tableWidgetConfigurationObjects_currentItemChanged(QTableWidgetItem *current, QTableWidgetItem *previous);
+    void on_pushButtonCalibrateCellNeighbourCollect_clicked();
 
 private:
     // scene related
@@ -140,6 +150,14 @@ private:
     void                    addSceneObject(SceneObjectPtr object, const QString &fileName);
     void                    removeSceneObject(int row);
 
+    // converted scene shared by all configuration space builders
+    SceneSnapshotPtr        m_sceneSnapshot;
+    unsigned int            m_sceneVersion;
+
+    SceneSnapshotPtr        sceneSnapshot(SceneObject::Type type);
+    void                    invalidateSceneSnapshot();
+    bool                    checkSceneSnapshot(SceneSnapshotPtr snapshot);
+
     // configuration space related
     typedef std::vector<ConfigurationObjectPtr> ConfigurationObjects;
     ConfigurationObjects    m_configurationObjects;
@@ -155,8 +173,35 @@ private:
 
     int                     m_configurationObjectPopupRow;
 
-    // other
-    bool                    readSceneFromStream(QDataStream &dataStream);
+    // scene import, files are read on workers and the results are passed
+    // to the finish functions on the GUI thread
+    struct ArrScene;
+
+    typedef boost::shared_ptr<SceneObjectPtr>       SceneObjectResult;
+    typedef boost::shared_ptr<SphereTreeLoader>     SphereTreeResult;
+    typedef boost::shared_ptr<ArrScene>             ArrSceneResult;
+
+    TaskRunner *            m_sceneImport;
+    QProgressDialog *       m_sceneImportDialog;
+    QString                 m_sceneImportTitle;
+
+    void                    startSceneImport(const QString &title, const std::vector<TaskRunner::Task> &tasks, const TaskRunner::Finish &finish);
+
+    void                    finishTextImport(SceneObjectResult object, const QString &fileName);
+    void                    finishDirectoryImport(SceneObjectResult robot, SceneObjectResult obstacle, const QString &directory);
+    void                    finishSphereTreeImport(SphereTreeResult loader, const QString &fileName);
+    void                    finishArrImport(ArrSceneResult scene);
+
+    static bool             loadSceneFile(const QString &fileName, ArrSceneResult scene, ImportProgress &progress);
+    static bool             readSceneFromStream(QDataStream &dataStream, ArrScene &scene, ImportProgress &progress);
+
+    // neighbour collect calibration, on a worker like the imports
+    typedef boost::shared_ptr<NeighbourCollectProfile> CalibrationResult;
+
+    TaskRunner *            m_calibration;
+    QProgressDialog *       m_calibrationDialog;
+
+    void                    finishCalibration(CalibrationResult profile);
 
     // route
     RoutePtr                selectedRoute() const;
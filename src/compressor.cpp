@@ -55,7 +55,9 @@ void Compressor::decompress(const std::string &input, std::string &output)
 
 #include "miniz.c"
 #include <malloc.h>
+#include <limits>
 #include <stdexcept>
+#include <vector>
 
 void Compressor::compress(const std::string &input, std::string &output)
 {
@@ -111,4 +113,76 @@ void Compressor::decompress(const std::string &input, std::string &output)
     free(destination);
 }
 
+namespace // anonymous
+{
+// size of the portable header
+const size_t PORTABLE_SIZE_BYTES = 8;
+
+// deflate codes a 258-byte match in no less than two bits
+const unsigned long long MAXIMUM_DEFLATE_RATIO = 1032;
+} // namespace anonymous
+
+void Compressor::compressPortable(const std::string &input, std::string &output)
+{
+    mz_ulong sourceLength = static_cast<mz_ulong>(input.size());
+
+    if (static_cast<size_t>(sourceLength) != input.size())
+        throw std::runtime_error("input too large!");
+
+    // prepare output buffer
+    mz_ulong destinationLength = mz_compressBound(sourceLength);
+    std::vector<unsigned char> destination(destinationLength);
+
+    // compress
+    int result = mz_compress2(&destination[0], &destinationLength,
+                              reinterpret_cast<const unsigned char *>(input.data()), sourceLength, 9);
+
+    if (result != MZ_OK)
+        throw std::runtime_error("mz_compress2 failed!");
+
+    // store result
+    unsigned long long size = input.size();
+    output.resize(PORTABLE_SIZE_BYTES);
+
+    for (size_t i = 0; i < PORTABLE_SIZE_BYTES; ++i)
+        output[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+
+    output.append(reinterpret_cast<const char *>(&destination[0]), static_cast<size_t>(destinationLength));
+}
+
+void Compressor::decompressPortable(const std::string &input, std::string &output)
+{
+    if (input.size() < PORTABLE_SIZE_BYTES)
+        throw std::runtime_error("missing size!");
+
+    unsigned long long size = 0;
+
+    for (size_t i = 0; i < PORTABLE_SIZE_BYTES; ++i)
+        size |= static_cast<unsigned long long>(static_cast<unsigned char>(input[i])) << (8 * i);
+
+    if (size > std::numeric_limits<mz_ulong>::max() || size > std::numeric_limits<size_t>::max() - 1)
+        throw std::runtime_error("size too large!");
+
+    // a damaged header must not allocate more than the stream can hold
+    if (size / MAXIMUM_DEFLATE_RATIO > input.size() - PORTABLE_SIZE_BYTES)
+        throw std::runtime_error("size too large for the stream!");
+
+    // prepare output buffer, never empty
+    std::vector<unsigned char> destination(static_cast<size_t>(size) + 1);
+    mz_ulong destinationLength = static_cast<mz_ulong>(size);
+
+    // input buffer is the zlib stream only
+    const unsigned char *source = reinterpret_cast<const unsigned char *>(input.data()) + PORTABLE_SIZE_BYTES;
+    mz_ulong sourceLength = static_cast<mz_ulong>(input.size() - PORTABLE_SIZE_BYTES);
+
+    // decompress
+    int result = mz_uncompress(&destination[0], &destinationLength, source, sourceLength);
+
+    if (result != MZ_OK || destinationLength != static_cast<mz_ulong>(size))
+        throw std::runtime_error("mz_uncompress failed!");
+
+    // store result
+    output.assign(reinterpret_cast<const char *>(&destination[0]), static_cast<size_t>(size));
+}
+
 #endif
@@ -24,8 +24,14 @@
 
 struct Compressor
 {
+    // the uncompressed size is stored first as a host unsigned long
     static void compress(const std::string &input, std::string &output);
     static void decompress(const std::string &input, std::string &output);
+
+    // the uncompressed size is stored first as a little-endian 64-bit
+    // integer, so data can be read on any platform
+    static void compressPortable(const std::string &input, std::string &output);
+    static void decompressPortable(const std::string &input, std::string &output);
 };
 
 #endif // COMPRESSOR_H
@@ -0,0 +1,228 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "decimalblock.h"
+#include "compressor.h"
+#include <QByteArray>
+#include <QtEndian>
+#include <QtGlobal>
+#include <algorithm>
+#include <climits>
+#include <exception>
+#include <string>
+
+namespace // anonymous
+{
+// zeros do not constrain the common exponent
+const int ZERO_EXPONENT = INT_MAX;
+
+// split into mantissa and exponent, fails for values without a short exact
+// form; those are on the slow path of the decimal and go to the text encoding
+bool decompose(const QDecimal &decimal, qint64 &mantissa, int &exponent)
+{
+    if (!decimal.isFast())
+        return false;
+
+    mantissa = decimal.mantissa();
+    exponent = decimal.exponent();
+
+    if (!mantissa)
+    {
+        exponent = ZERO_EXPONENT;
+        return true;
+    }
+
+    // drop trailing zeros
+    while (mantissa % 10 == 0)
+    {
+        mantissa /= 10;
+        ++exponent;
+    }
+
+    return true;
+}
+
+// scale all values to the smallest exponent, fails on overflow
+bool toMantissas(const std::vector<QDecimal> &decimals, std::vector<qint64> &mantissas, int &commonExponent)
+{
+    std::vector<int> exponents(decimals.size());
+    mantissas.resize(decimals.size());
+
+    commonExponent = ZERO_EXPONENT;
+
+    for (size_t i = 0; i < decimals.size(); ++i)
+    {
+        if (!decompose(decimals[i], mantissas[i], exponents[i]))
+            return false;
+
+        commonExponent = std::min(commonExponent, exponents[i]);
+    }
+
+    if (commonExponent == ZERO_EXPONENT)
+        commonExponent = 0;
+
+    for (size_t i = 0; i < decimals.size(); ++i)
+    {
+        if (!mantissas[i])
+            continue;
+
+        for (int shift = exponents[i] - commonExponent; shift > 0; --shift)
+        {
+            if (mantissas[i] > LLONG_MAX / 10 || mantissas[i] < -(LLONG_MAX / 10))
+                return false;
+
+            mantissas[i] *= 10;
+        }
+    }
+
+    return true;
+}
+
+bool fromMantissas(const char *data, size_t size, int exponent, std::vector<QDecimal> &decimals)
+{
+    if (size != decimals.size() * sizeof(qint64))
+        return false;
+
+    for (size_t i = 0; i < decimals.size(); ++i)
+    {
+        qint64 mantissa = qFromLittleEndian<qint64>(reinterpret_cast<const uchar *>(data + i * sizeof(qint64)));
+        decimals[i] = QDecimal(mantissa, exponent);
+    }
+
+    return true;
+}
+
+bool fromText(const char *data, size_t size, std::vector<QDecimal> &decimals)
+{
+    const char *current = data;
+    const char *end = data + size;
+
+    for (size_t i = 0; i < decimals.size(); ++i)
+    {
+        const char *terminator = std::find(current, end, '\0');
+
+        if (terminator == end)
+            return false;
+
+        decimals[i].fromString(current);
+        current = terminator + 1;
+    }
+
+    return current == end;
+}
+} // namespace anonymous
+
+void DecimalBlock::write(QDataStream &stream, const std::vector<QDecimal> &decimals, bool compress)
+{
+    std::vector<qint64> mantissas;
+    int exponent;
+
+    Encoding encoding = toMantissas(decimals, mantissas, exponent) ? Encoding_Mantissas : Encoding_Text;
+
+    std::string payload;
+
+    if (encoding == Encoding_Mantissas)
+    {
+        payload.resize(mantissas.size() * sizeof(qint64));
+
+        for (size_t i = 0; i < mantissas.size(); ++i)
+            qToLittleEndian<qint64>(mantissas[i], reinterpret_cast<uchar *>(&payload[i * sizeof(qint64)]));
+    }
+    else
+    {
+        exponent = 0;
+
+        for (std::vector<QDecimal>::const_iterator it = decimals.begin(); it != decimals.end(); ++it)
+        {
+            QByteArray text = it->toString();
+            payload.append(text.constData(), static_cast<size_t>(text.size()));
+            payload.push_back('\0');
+        }
+    }
+
+    if (compress)
+    {
+        std::string compressed;
+        Compressor::compressPortable(payload, compressed);
+        payload.swap(compressed);
+    }
+
+    stream << static_cast<quint8>(encoding);
+    stream << static_cast<quint8>(compress);
+    stream << static_cast<qint32>(exponent);
+    stream << static_cast<quint32>(decimals.size());
+
+    stream.writeBytes(payload.data(), static_cast<uint>(payload.size()));
+}
+
+bool DecimalBlock::read(QDataStream &stream, std::vector<QDecimal> &decimals)
+{
+    quint8 encoding, compressed;
+    qint32 exponent;
+    quint32 count;
+
+    stream >> encoding >> compressed >> exponent >> count;
+
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    char *data;
+    uint length;
+
+    stream.readBytes(data, length);
+
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    std::string payload(data, data + length);
+    delete [] data;
+
+    if (compressed)
+    {
+        std::string uncompressed;
+
+        try
+        {
+            Compressor::decompressPortable(payload, uncompressed);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+
+        payload.swap(uncompressed);
+    }
+
+    // every value takes at least one byte
+    if (count > payload.size())
+        return false;
+
+    decimals.resize(count);
+
+    switch (encoding)
+    {
+    case Encoding_Mantissas:
+        return fromMantissas(payload.data(), payload.size(), exponent, decimals);
+
+    case Encoding_Text:
+        return fromText(payload.data(), payload.size(), decimals);
+    }
+
+    return false;
+}
@@ -0,0 +1,44 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DECIMALBLOCK_H
+#define DECIMALBLOCK_H
+
+#include "qdecimal.h"
+#include <QDataStream>
+#include <vector>
+
+// an array of decimals stored as 64-bit mantissas scaled to a common
+// exponent, optionally compressed as a whole
+//
+// arrays with values which do not fit (too many digits, infinities)
+// are stored as text instead, so every decimal survives a round trip
+struct DecimalBlock
+{
+    enum Encoding
+    {
+        Encoding_Mantissas,
+        Encoding_Text
+    };
+
+    static void write(QDataStream &stream, const std::vector<QDecimal> &decimals, bool compress);
+    static bool read(QDataStream &stream, std::vector<QDecimal> &decimals);
+};
+
+#endif // DECIMALBLOCK_H
@@ -21,6 +21,9 @@
 #define DECIMALSCENE_H
 
 #include "qdecimal.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <vector>
 #include <cassert>
@@ -138,45 +141,136 @@ private:
 typedef std::vector<DecimalVector>  DecimalVectorList;
 typedef std::vector<DecimalFace>    DecimalFaceList;
 
+// a triangle over vertices of a shared vertex array
 class DecimalTriangle
 {
 public:
-    DecimalTriangle()
+    DecimalTriangle(const DecimalVector *vertexA, const DecimalVector *vertexB, const DecimalVector *vertexC)
+        : m_vertexA(vertexA), m_vertexB(vertexB), m_vertexC(vertexC)
     {
-        m_vertexA = m_vertexB = m_vertexC = DecimalVector(0, 0, 0);
-        m_normal = cross(m_vertexB - m_vertexA, m_vertexC - m_vertexA);
     }
 
-    DecimalTriangle(const DecimalVector &vertexA, const DecimalVector &vertexB, const DecimalVector &vertexC)
+    const DecimalVector &   vertex(int i) const
     {
-        m_vertexA = vertexA;
-        m_vertexB = vertexB;
-        m_vertexC = vertexC;
-        m_normal = cross(m_vertexB - m_vertexA, m_vertexC - m_vertexA);
+        switch (i)
+        {
+        case 0: return *m_vertexA;
+        case 1: return *m_vertexB;
+        case 2: return *m_vertexC;
+        default: assert(0); return *m_vertexA;
+        }
     }
 
-    const DecimalVector &   vertex(int i) const
+    // not stored, computed on every call; lists cache them
+    DecimalVector           normal() const
     {
-        switch (i)
+        return cross(*m_vertexB - *m_vertexA, *m_vertexC - *m_vertexA);
+    }
+
+private:
+    const DecimalVector *m_vertexA, *m_vertexB, *m_vertexC;
+};
+
+// an indexed triangle mesh; triangles refer to the vertex array
+// of the list, so lists cannot be copied
+//
+// faces are not stored, their indices follow from the triangles
+class DecimalTriangleList
+    : private boost::noncopyable
+{
+public:
+    typedef std::vector<DecimalTriangle>::const_iterator const_iterator;
+
+    // faces must index existing vertices
+    DecimalTriangleList(const DecimalVectorList &vertices, const DecimalFaceList &faces)
+        : m_vertices(vertices),
+          m_normalsComputed(false)
+    {
+        m_triangles.reserve(faces.size());
+
+        for (DecimalFaceList::const_iterator it = faces.begin(); it != faces.end(); ++it)
         {
-        case 0: return m_vertexA;
-        case 1: return m_vertexB;
-        case 2: return m_vertexC;
-        default: assert(0); return m_vertexA;
+            assert(it->vertex(0) < m_vertices.size() && it->vertex(1) < m_vertices.size() && it->vertex(2) < m_vertices.size());
+
+            m_triangles.push_back(DecimalTriangle(&m_vertices[it->vertex(0)],
+                                                  &m_vertices[it->vertex(1)],
+                                                  &m_vertices[it->vertex(2)]));
+        }
+    }
+
+    const DecimalVectorList &   vertices() const
+    {
+        return m_vertices;
+    }
+
+    DecimalFace                 face(size_t index) const
+    {
+        const DecimalTriangle &triangle = m_triangles[index];
+
+        return DecimalFace(vertexIndex(triangle.vertex(0)),
+                           vertexIndex(triangle.vertex(1)),
+                           vertexIndex(triangle.vertex(2)));
+    }
+
+    // built on every call
+    DecimalFaceList             faces() const
+    {
+        DecimalFaceList result;
+        result.reserve(m_triangles.size());
+
+        for (size_t i = 0; i < m_triangles.size(); ++i)
+            result.push_back(face(i));
+
+        return result;
+    }
+
+    // computed for all triangles on the first call, then kept
+    const DecimalVector &       normal(size_t index) const
+    {
+        QMutexLocker locker(&m_normalsMutex);
+
+        if (!m_normalsComputed)
+        {
+            m_normals.reserve(m_triangles.size());
+
+            for (const_iterator it = begin(); it != end(); ++it)
+                m_normals.push_back(it->normal());
+
+            m_normalsComputed = true;
         }
+
+        return m_normals[index];
+    }
+
+    size_t                      size() const
+    {
+        return m_triangles.size();
+    }
+
+    const_iterator              begin() const
+    {
+        return m_triangles.begin();
     }
 
-    const DecimalVector &   normal() const
+    const_iterator              end() const
     {
-        return m_normal;
+        return m_triangles.end();
     }
 
 private:
-    DecimalVector   m_vertexA, m_vertexB, m_vertexC;
-    DecimalVector   m_normal;
+    DecimalVectorList               m_vertices;
+    std::vector<DecimalTriangle>    m_triangles;
+
+    mutable QMutex                  m_normalsMutex;
+    mutable DecimalVectorList       m_normals;
+    mutable bool                    m_normalsComputed;
+
+    size_t                          vertexIndex(const DecimalVector &vertex) const
+    {
+        return static_cast<size_t>(&vertex - &m_vertices[0]);
+    }
 };
 
-typedef std::vector<DecimalTriangle>            DecimalTriangleList;
 typedef boost::shared_ptr<DecimalTriangleList>  DecimalTriangleListPtr;
 
 class DecimalBall
@@ -218,4 +312,85 @@ private:
 typedef std::vector<DecimalBall>            DecimalBallList;
 typedef boost::shared_ptr<DecimalBallList>  DecimalBallListPtr;
 
+// a ball hierarchy; nodes are stored level by level so that
+// children of every node are contiguous
+class DecimalBallTree
+{
+public:
+    static const int NO_NODE = -1;
+
+    // add a node after all nodes of the previous level and after
+    // all earlier children of the same parent; leaf is the index of
+    // the ball in the owning ball list or NO_NODE for inner nodes
+    size_t                  addNode(const DecimalBall &ball, int parent, int leaf)
+    {
+        size_t index = m_nodes.size();
+
+        Node node;
+        node.ball = ball;
+        node.parent = parent;
+        node.leaf = leaf;
+        node.firstChild = 0;
+        node.numberOfChildren = 0;
+
+        if (parent != NO_NODE)
+        {
+            Node &parentNode = m_nodes[static_cast<size_t>(parent)];
+
+            if (!parentNode.numberOfChildren)
+                parentNode.firstChild = index;
+
+            assert(parentNode.firstChild + parentNode.numberOfChildren == index);
+            ++parentNode.numberOfChildren;
+        }
+
+        m_nodes.push_back(node);
+        return index;
+    }
+
+    size_t                  numberOfNodes() const
+    {
+        return m_nodes.size();
+    }
+
+    const DecimalBall &     ball(size_t node) const
+    {
+        return m_nodes[node].ball;
+    }
+
+    int                     parent(size_t node) const
+    {
+        return m_nodes[node].parent;
+    }
+
+    int                     leaf(size_t node) const
+    {
+        return m_nodes[node].leaf;
+    }
+
+    size_t                  firstChild(size_t node) const
+    {
+        return m_nodes[node].firstChild;
+    }
+
+    size_t                  numberOfChildren(size_t node) const
+    {
+        return m_nodes[node].numberOfChildren;
+    }
+
+private:
+    struct Node
+    {
+        DecimalBall     ball;
+        int             parent;
+        int             leaf;
+        size_t          firstChild;
+        size_t          numberOfChildren;
+    };
+
+    std::vector<Node>   m_nodes;
+};
+
+typedef boost::shared_ptr<DecimalBallTree>  DecimalBallTreePtr;
+
 #endif // DECIMALSCENE_H
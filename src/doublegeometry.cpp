@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "doublegeometry.h"
+#include <algorithm>
+#include <cmath>
+
+DoubleGeometry::DoubleGeometry(const DecimalBallList &balls)
+{
+    reserve(balls.size());
+    m_radii.reserve(balls.size());
+
+    for (DecimalBallList::const_iterator it = balls.begin(); it != balls.end(); ++it)
+    {
+        addPoint(it->center());
+        m_radii.push_back(it->radius().toDouble());
+    }
+
+    computeBounds();
+}
+
+DoubleGeometry::DoubleGeometry(const DecimalTriangleList &triangles)
+{
+    reserve(triangles.vertices().size());
+
+    for (DecimalVectorList::const_iterator it = triangles.vertices().begin(); it != triangles.vertices().end(); ++it)
+        addPoint(*it);
+
+    computeBounds();
+}
+
+size_t DoubleGeometry::numberOfPoints() const
+{
+    return m_x.size();
+}
+
+const std::vector<double> &DoubleGeometry::x() const
+{
+    return m_x;
+}
+
+const std::vector<double> &DoubleGeometry::y() const
+{
+    return m_y;
+}
+
+const std::vector<double> &DoubleGeometry::z() const
+{
+    return m_z;
+}
+
+const std::vector<double> &DoubleGeometry::radii() const
+{
+    return m_radii;
+}
+
+const double *DoubleGeometry::minimum() const
+{
+    return m_minimum;
+}
+
+const double *DoubleGeometry::maximum() const
+{
+    return m_maximum;
+}
+
+const double *DoubleGeometry::center() const
+{
+    return m_center;
+}
+
+double DoubleGeometry::radius() const
+{
+    return m_radius;
+}
+
+void DoubleGeometry::reserve(size_t numberOfPoints)
+{
+    m_x.reserve(numberOfPoints);
+    m_y.reserve(numberOfPoints);
+    m_z.reserve(numberOfPoints);
+}
+
+void DoubleGeometry::addPoint(const DecimalVector &point)
+{
+    m_x.push_back(point.x().toDouble());
+    m_y.push_back(point.y().toDouble());
+    m_z.push_back(point.z().toDouble());
+}
+
+void DoubleGeometry::computeBounds()
+{
+    for (int i = 0; i < 3; ++i)
+        m_minimum[i] = m_maximum[i] = m_center[i] = 0;
+
+    m_radius = 0;
+
+    if (m_x.empty())
+        return;
+
+    const std::vector<double> *coordinates[3] = { &m_x, &m_y, &m_z };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        m_minimum[i] = m_maximum[i] = (*coordinates[i])[0];
+
+        for (size_t j = 0; j < m_x.size(); ++j)
+        {
+            double extent = m_radii.empty() ? 0 : m_radii[j];
+
+            m_minimum[i] = std::min(m_minimum[i], (*coordinates[i])[j] - extent);
+            m_maximum[i] = std::max(m_maximum[i], (*coordinates[i])[j] + extent);
+        }
+
+        m_center[i] = 0.5 * (m_minimum[i] + m_maximum[i]);
+    }
+
+    // sphere about the box centre, not the smallest one
+    for (size_t j = 0; j < m_x.size(); ++j)
+    {
+        double dx = m_x[j] - m_center[0];
+        double dy = m_y[j] - m_center[1];
+        double dz = m_z[j] - m_center[2];
+
+        m_radius = std::max(m_radius, std::sqrt(dx * dx + dy * dy + dz * dz) + (m_radii.empty() ? 0 : m_radii[j]));
+    }
+}
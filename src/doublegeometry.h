@@ -0,0 +1,72 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DOUBLEGEOMETRY_H
+#define DOUBLEGEOMETRY_H
+
+#include "decimalscene.h"
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+// double precision copy of the geometry of one scene object, one array
+// per coordinate; points are ball centres or mesh vertices in the order
+// of the decimal geometry
+class DoubleGeometry
+    : private boost::noncopyable
+{
+public:
+    explicit DoubleGeometry(const DecimalBallList &balls);
+    explicit DoubleGeometry(const DecimalTriangleList &triangles);
+
+    size_t                      numberOfPoints() const;
+
+    const std::vector<double> & x() const;
+    const std::vector<double> & y() const;
+    const std::vector<double> & z() const;
+
+    // empty for meshes
+    const std::vector<double> & radii() const;
+
+    // bounds of the whole geometry, balls included
+    const double *              minimum() const;
+    const double *              maximum() const;
+
+    const double *              center() const;
+    double                      radius() const;
+
+private:
+    std::vector<double>     m_x;
+    std::vector<double>     m_y;
+    std::vector<double>     m_z;
+    std::vector<double>     m_radii;
+
+    double                  m_minimum[3];
+    double                  m_maximum[3];
+    double                  m_center[3];
+    double                  m_radius;
+
+    void                    reserve(size_t numberOfPoints);
+    void                    addPoint(const DecimalVector &point);
+    void                    computeBounds();
+};
+
+typedef boost::shared_ptr<DoubleGeometry> DoubleGeometryPtr;
+
+#endif // DOUBLEGEOMETRY_H
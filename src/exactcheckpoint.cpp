@@ -0,0 +1,416 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "exactcheckpoint.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <log4cxx/logger.h>
+#include <algorithm>
+#include <exception>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.exactcheckpoint"));
+
+const quint32 CHECKPOINT_MAGIC = 0x41434b50;     // "ACKP"
+const quint32 CHECKPOINT_VERSION = 1;
+
+// stores of other builds kept, least recently used ones are removed
+const int MAXIMUM_STORED_BUILDS = 8;
+
+// touched whenever a store is opened
+const char *const LAST_USE_FILE_NAME = "last-use";
+
+QDateTime lastUse(const QFileInfo &store)
+{
+    return QFileInfo(store.absoluteFilePath() + "/" + LAST_USE_FILE_NAME).lastModified();
+}
+
+bool isUsedLater(const QFileInfo &left, const QFileInfo &right)
+{
+    return lastUse(left) > lastUse(right);
+}
+
+void markUsed(const QString &directory)
+{
+    // rewriting the file updates its modification time
+    QFile file(directory + "/" + LAST_USE_FILE_NAME);
+
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toLatin1());
+}
+
+void removeOldStores(const QString &root, const QString &current)
+{
+    QFileInfoList stores = QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    std::sort(stores.begin(), stores.end(), isUsedLater);
+
+    int kept = 0;
+
+    foreach (const QFileInfo &store, stores)
+    {
+        if (store.absoluteFilePath() == QFileInfo(current).absoluteFilePath())
+            continue;
+
+        if (++kept <= MAXIMUM_STORED_BUILDS)
+            continue;
+
+        if (QDir(store.absoluteFilePath()).removeRecursively())
+            LOG4CXX_INFO(g_logger, "Removed old checkpoint directory " << store.absoluteFilePath().toStdString());
+    }
+}
+
+void writeHeader(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << CHECKPOINT_MAGIC << CHECKPOINT_VERSION;
+}
+
+bool readHeader(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    stream >> magic >> version;
+
+    return stream.status() == QDataStream::Ok && magic == CHECKPOINT_MAGIC && version == CHECKPOINT_VERSION;
+}
+
+// sizes of the records behind a count, a corrupt count is caught before
+// anything is allocated for it
+const quint64 TRIANGLE_RECORD_SIZE = 18 * sizeof(double);
+const quint64 SPIN_RECORD_SIZE = 4 * sizeof(double);
+const quint64 SPIN_LIST_RECORD_SIZE = sizeof(quint64);
+
+bool fitsInStream(const QDataStream &stream, quint64 count, quint64 recordSize)
+{
+    qint64 available = stream.device()->bytesAvailable();
+    return available >= 0 && count <= static_cast<quint64>(available) / recordSize;
+}
+
+void writePoint(QDataStream &stream, double x, double y, double z)
+{
+    stream << x << y << z;
+}
+
+void writeTriangles(QDataStream &stream, const Mesh_smooth_triangle_list_3_Z &triangles)
+{
+    stream << static_cast<quint64>(triangles.size());
+
+    for (Mesh_smooth_triangle_list_3_Z::const_iterator it = triangles.begin(); it != triangles.end(); ++it)
+    {
+        for (int v = 0; v < 3; ++v)
+            writePoint(stream, it->vertex(v).x(), it->vertex(v).y(), it->vertex(v).z());
+
+        writePoint(stream, it->normal_0().x(), it->normal_0().y(), it->normal_0().z());
+        writePoint(stream, it->normal_1().x(), it->normal_1().y(), it->normal_1().z());
+        writePoint(stream, it->normal_2().x(), it->normal_2().y(), it->normal_2().z());
+    }
+}
+
+bool readTriangles(QDataStream &stream, Mesh_smooth_triangle_list_3_Z &triangles)
+{
+    typedef Mesh_smooth_triangle_3_Z::Triangle_3    Triangle_3;
+    typedef Mesh_smooth_triangle_3_Z::Point_3       Point_3;
+    typedef Mesh_smooth_triangle_3_Z::Vector_3      Vector_3;
+
+    quint64 count;
+    stream >> count;
+
+    if (stream.status() != QDataStream::Ok || !fitsInStream(stream, count, TRIANGLE_RECORD_SIZE))
+        return false;
+
+    // a damaged file is a cache miss, the primitive is meshed again
+    try
+    {
+        triangles.reserve(static_cast<size_t>(count));
+
+        for (quint64 i = 0; i < count; ++i)
+        {
+            double c[18];
+
+            for (int k = 0; k < 18; ++k)
+                stream >> c[k];
+
+            if (stream.status() != QDataStream::Ok)
+                return false;
+
+            triangles.push_back(Mesh_smooth_triangle_3_Z(Triangle_3(Point_3(c[0], c[1], c[2]),
+                                                                    Point_3(c[3], c[4], c[5]),
+                                                                    Point_3(c[6], c[7], c[8])),
+                                                         Vector_3(c[9], c[10], c[11]),
+                                                         Vector_3(c[12], c[13], c[14]),
+                                                         Vector_3(c[15], c[16], c[17])));
+        }
+    }
+    catch (const std::exception &exception)
+    {
+        LOG4CXX_INFO(g_logger, "Ignored damaged checkpoint: " << exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+template<typename Spin>
+void writeSpins(QDataStream &stream, const std::vector<Spin> &spins)
+{
+    stream << static_cast<quint64>(spins.size());
+
+    for (typename std::vector<Spin>::const_iterator it = spins.begin(); it != spins.end(); ++it)
+        stream << it->s12() << it->s23() << it->s31() << it->s0();
+}
+
+template<typename Spin>
+bool readSpins(QDataStream &stream, std::vector<Spin> &spins)
+{
+    quint64 count;
+    stream >> count;
+
+    if (stream.status() != QDataStream::Ok || !fitsInStream(stream, count, SPIN_RECORD_SIZE))
+        return false;
+
+    // a damaged file is a cache miss, the primitive is meshed again
+    try
+    {
+        spins.reserve(static_cast<size_t>(count));
+
+        for (quint64 i = 0; i < count; ++i)
+        {
+            double s12, s23, s31, s0;
+            stream >> s12 >> s23 >> s31 >> s0;
+
+            if (stream.status() != QDataStream::Ok)
+                return false;
+
+            spins.push_back(Spin(s12, s23, s31, s0));
+        }
+    }
+    catch (const std::exception &exception)
+    {
+        LOG4CXX_INFO(g_logger, "Ignored damaged checkpoint: " << exception.what());
+        return false;
+    }
+
+    return true;
+}
+
+// the file is replaced only when it is complete
+bool commit(QSaveFile &file, const QDataStream &stream)
+{
+    if (stream.status() != QDataStream::Ok)
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+} // namespace anonymous
+
+ExactCheckpoint::ExactCheckpoint(const std::string &buildKey)
+    : m_valid(false)
+{
+    QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+    if (root.isEmpty())
+        root = QDir::tempPath() + "/arrangement";
+
+    m_directory = root + "/checkpoints/" + QString::fromStdString(buildKey);
+    m_valid = QDir().mkpath(m_directory);
+
+    if (m_valid)
+    {
+        LOG4CXX_INFO(g_logger, "Exact checkpoints in " << m_directory.toStdString());
+
+        markUsed(m_directory);
+        removeOldStores(root + "/checkpoints", m_directory);
+    }
+    else
+    {
+        LOG4CXX_INFO(g_logger, "Failed to create checkpoint directory " << m_directory.toStdString());
+    }
+}
+
+bool ExactCheckpoint::isValid() const
+{
+    return m_valid;
+}
+
+const QString &ExactCheckpoint::directory() const
+{
+    return m_directory;
+}
+
+bool ExactCheckpoint::loadTriangles(const std::string &key, int level,
+                                    Mesh_smooth_triangle_list_3_Z &left,
+                                    Mesh_smooth_triangle_list_3_Z &right) const
+{
+    if (!m_valid)
+        return false;
+
+    QFile file(fileName("quadric", key, level));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+
+    if (!readHeader(stream) || !readTriangles(stream, left) || !readTriangles(stream, right))
+    {
+        left.clear();
+        right.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void ExactCheckpoint::saveTriangles(const std::string &key, int level,
+                                    const Mesh_smooth_triangle_list_3_Z &left,
+                                    const Mesh_smooth_triangle_list_3_Z &right) const
+{
+    if (!m_valid)
+        return;
+
+    QSaveFile file(fileName("quadric", key, level));
+
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    writeHeader(stream);
+    writeTriangles(stream, left);
+    writeTriangles(stream, right);
+
+    commit(file, stream);
+}
+
+bool ExactCheckpoint::loadSpinLists(const std::string &key, int level,
+                                    std::vector<Qsic_spin_list_3_Z_ptr> &spinLists) const
+{
+    if (!m_valid)
+        return false;
+
+    QFile file(fileName("qsic", key, level));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+
+    if (!readHeader(stream))
+        return false;
+
+    quint64 count;
+    stream >> count;
+
+    if (stream.status() != QDataStream::Ok || !fitsInStream(stream, count, SPIN_LIST_RECORD_SIZE))
+        return false;
+
+    std::vector<Qsic_spin_list_3_Z_ptr> result;
+
+    for (quint64 i = 0; i < count; ++i)
+    {
+        Qsic_spin_list_3_Z_ptr spinList(new Qsic_spin_list_3_Z());
+
+        if (!readSpins(stream, *spinList))
+            return false;
+
+        result.push_back(spinList);
+    }
+
+    spinLists.swap(result);
+    return true;
+}
+
+void ExactCheckpoint::saveSpinLists(const std::string &key, int level,
+                                    const std::vector<Qsic_spin_list_3_Z_ptr> &spinLists) const
+{
+    if (!m_valid)
+        return;
+
+    QSaveFile file(fileName("qsic", key, level));
+
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    writeHeader(stream);
+
+    stream << static_cast<quint64>(spinLists.size());
+
+    for (std::vector<Qsic_spin_list_3_Z_ptr>::const_iterator it = spinLists.begin(); it != spinLists.end(); ++it)
+        writeSpins(stream, **it);
+
+    commit(file, stream);
+}
+
+bool ExactCheckpoint::loadPoints(const std::string &key, std::vector<Qsip_spin_3_Z> &points) const
+{
+    if (!m_valid)
+        return false;
+
+    QFile file(fileName("qsip", key, 0));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+
+    std::vector<Qsip_spin_3_Z> result;
+
+    if (!readHeader(stream) || !readSpins(stream, result))
+        return false;
+
+    points.swap(result);
+    return true;
+}
+
+void ExactCheckpoint::savePoints(const std::string &key, const std::vector<Qsip_spin_3_Z> &points) const
+{
+    if (!m_valid)
+        return;
+
+    QSaveFile file(fileName("qsip", key, 0));
+
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream(&file);
+    writeHeader(stream);
+    writeSpins(stream, points);
+
+    commit(file, stream);
+}
+
+QString ExactCheckpoint::fileName(const char *kind, const std::string &key, int level) const
+{
+    // keys are long polynomial texts
+    QByteArray digest = QCryptographicHash::hash(QByteArray(key.c_str(), static_cast<int>(key.size())),
+                                                 QCryptographicHash::Sha1).toHex();
+
+    return QString("%1/%2-%3-%4.bin").arg(m_directory).arg(kind).arg(QString::fromLatin1(digest)).arg(level);
+}
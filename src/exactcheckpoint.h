@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EXACTCHECKPOINT_H
+#define EXACTCHECKPOINT_H
+
+#include "kernel.h"
+#include <QString>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+// on-disk store of meshed primitives of exact configuration spaces
+//
+// every primitive is written to its own file as soon as it is meshed, so
+// a build which was interrupted resumes with everything meshed before;
+// builds of the same scene share one store, so a build can be staged by
+// computing quadrics first and QSICs and QSIPs in a later run
+//
+// all methods may be called from meshing jobs concurrently, as long as
+// no two of them use the same primitive key
+//
+// the cache keeps the stores of the last few builds, older ones are
+// removed when a store is opened
+class ExactCheckpoint
+    : private boost::noncopyable
+{
+public:
+    // build key identifies the scene and configuration space type
+    explicit ExactCheckpoint(const std::string &buildKey);
+
+    // false if the store directory could not be created
+    bool            isValid() const;
+
+    const QString & directory() const;
+
+    bool            loadTriangles(const std::string &key, int level,
+                                  Mesh_smooth_triangle_list_3_Z &left,
+                                  Mesh_smooth_triangle_list_3_Z &right) const;
+
+    void            saveTriangles(const std::string &key, int level,
+                                  const Mesh_smooth_triangle_list_3_Z &left,
+                                  const Mesh_smooth_triangle_list_3_Z &right) const;
+
+    bool            loadSpinLists(const std::string &key, int level,
+                                  std::vector<Qsic_spin_list_3_Z_ptr> &spinLists) const;
+
+    void            saveSpinLists(const std::string &key, int level,
+                                  const std::vector<Qsic_spin_list_3_Z_ptr> &spinLists) const;
+
+    bool            loadPoints(const std::string &key, std::vector<Qsip_spin_3_Z> &points) const;
+    void            savePoints(const std::string &key, const std::vector<Qsip_spin_3_Z> &points) const;
+
+private:
+    QString         m_directory;
+    bool            m_valid;
+
+    QString         fileName(const char *kind, const std::string &key, int level) const;
+};
+
+typedef boost::shared_ptr<ExactCheckpoint> ExactCheckpointPtr;
+
+#endif // EXACTCHECKPOINT_H
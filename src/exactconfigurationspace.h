@@ -24,12 +24,21 @@
 #include "genericrouter.h"
 #include "trianglelistmesh.h"
 #include "polyconemesh.h"
-#include "ballmesh.h"
+#include "balllistmesh.h"
+#include "canonicalkey.h"
+#include "exactcheckpoint.h"
+#include "lodmeshcache.h"
 #include "material.h"
+#include "meshingbudget.h"
 #include <QDataStream>
-#include <boost/scoped_array.hpp>
-#include <boost/scoped_ptr.hpp>
-#include <stdexcept>
+#include <QVector3D>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
 
 class QGLWidget;
 
@@ -39,11 +48,245 @@ struct ExactConfigurationSpaceTag
     typedef Tag_ Tag;
 };
 
+// meshes a spin quadric at a level of detail of LodMeshCache
+template<class SpinQuadric_>
+class SpinQuadricLodMesher
+{
+public:
+    SpinQuadricLodMesher(const SpinQuadric_ *spinQuadric, const std::string &key,
+                         ExactCheckpointPtr checkpoint, QGLWidget *gl)
+        : m_spinQuadric(spinQuadric),
+          m_key(key),
+          m_checkpoint(checkpoint),
+          m_gl(gl)
+    {
+    }
+
+    bool operator()(int level, MeshList &meshes, LodMeshCache::MeshInfo &info) const
+    {
+        Mesh_smooth_triangle_list_3_Z_ptr left(new Mesh_smooth_triangle_list_3_Z());
+        Mesh_smooth_triangle_list_3_Z_ptr right(new Mesh_smooth_triangle_list_3_Z());
+
+        if (!m_checkpoint || !m_checkpoint->loadTriangles(m_key, level, *left, *right))
+        {
+            Spin_quadric_mesh_3_Z mesher(*m_spinQuadric);
+
+            double angular_bound = 30;
+            double radius_bound = LodMeshCache::bound(level);
+            double distance_bound = LodMeshCache::bound(level);
+
+            mesher.mesh_triangle_soup(std::back_inserter(*left),
+                                      std::back_inserter(*right),
+                                      angular_bound,
+                                      radius_bound,
+                                      distance_bound);
+
+            if (m_checkpoint)
+                m_checkpoint->saveTriangles(m_key, level, *left, *right);
+        }
+
+        // display lists are compiled on first render
+        meshes.push_back(MeshPtr(new TriangleListMesh(m_gl, left)));
+        meshes.push_back(MeshPtr(new TriangleListMesh(m_gl, right)));
+
+        info.bytes = (left->size() + right->size()) * sizeof(Mesh_smooth_triangle_3_Z);
+
+        for (Mesh_smooth_triangle_list_3_Z::const_iterator it = left->begin(); it != left->end(); ++it)
+            for (int vertex = 0; vertex < 3; ++vertex)
+                info.include(it->vertex(vertex).x(), it->vertex(vertex).y(), it->vertex(vertex).z());
+
+        for (Mesh_smooth_triangle_list_3_Z::const_iterator it = right->begin(); it != right->end(); ++it)
+            for (int vertex = 0; vertex < 3; ++vertex)
+                info.include(it->vertex(vertex).x(), it->vertex(vertex).y(), it->vertex(vertex).z());
+
+        return true;
+    }
+
+private:
+    const SpinQuadric_ *    m_spinQuadric;
+    std::string             m_key;
+    ExactCheckpointPtr      m_checkpoint;
+    QGLWidget *             m_gl;
+};
+
+// meshes the one dimensional components of a QSIC at a level of detail
+// of LodMeshCache; a QSIC whose components were already claimed by
+// another one has nothing to show
+template<class QsicHandle_>
+class QsicLodMesher
+{
+public:
+    QsicLodMesher(QsicHandle_ qsic, CanonicalKeySet *keys, ExactCheckpointPtr checkpoint, QGLWidget *gl)
+        : m_qsic(qsic),
+          m_keys(keys),
+          m_checkpoint(checkpoint),
+          m_gl(gl),
+          m_state(new State())
+    {
+    }
+
+    bool operator()(int level, MeshList &meshes, LodMeshCache::MeshInfo &info) const
+    {
+        // first call, the key is claimed before the expensive mesher is built
+        if (!m_state->claimed)
+        {
+            m_state->claimed = true;
+
+            // FIXME: if the component is not one dimensional, ignore it
+            for (size_t component = 0; component != m_qsic->size_of_components(); ++component)
+            {
+                if (m_qsic->component_dimension(component) != 1)
+                    continue;
+
+                m_state->components.push_back(component);
+                m_state->key += m_qsic->component_to_string(component);
+                m_state->key += '\n';
+            }
+
+            // another QSIC shows the same curve
+            if (!m_keys->insert(m_state->key))
+                m_state->components.clear();
+        }
+
+        if (m_state->components.empty())
+            return false;
+
+        std::vector<Qsic_spin_list_3_Z_ptr> spinLists;
+
+        if (!m_checkpoint || !m_checkpoint->loadSpinLists(m_state->key, level, spinLists))
+        {
+            if (!m_state->mesher)
+                m_state->mesher.reset(new Spin_qsic_mesh_3_Z(*m_qsic));
+
+            // each component
+            foreach (size_t component, m_state->components)
+            {
+                // evaluate curve
+                Qsic_spin_list_3_Z_ptr spinList(new Qsic_spin_list_3_Z());
+
+                m_state->mesher->mesh_component(*spinList, component, LodMeshCache::bound(level));
+
+                spinLists.push_back(spinList);
+            }
+
+            if (m_checkpoint)
+                m_checkpoint->saveSpinLists(m_state->key, level, spinLists);
+        }
+
+        foreach (const Qsic_spin_list_3_Z_ptr &spinList, spinLists)
+        {
+            // the antipodal component is the mirror image of the poly cone
+            meshes.push_back(MeshPtr(new PolyConeMesh(m_gl, spinList, 0.02, 12)));
+            info.bytes += spinList->size() * sizeof(Qsic_spin_3_Z);
+
+            for (Qsic_spin_list_3_Z::const_iterator it = spinList->begin(); it != spinList->end(); ++it)
+                info.include(it->s12(), it->s23(), it->s31());
+        }
+
+        return true;
+    }
+
+private:
+    // shared by the copies handed to meshing jobs
+    struct State
+    {
+        State() : claimed(false) {}
+
+        bool                    claimed;
+        Spin_qsic_mesh_3_Z_ptr  mesher;
+        std::vector<size_t>     components;
+        std::string             key;
+    };
+
+    QsicHandle_                 m_qsic;
+    CanonicalKeySet *           m_keys;
+    ExactCheckpointPtr          m_checkpoint;
+    QGLWidget *                 m_gl;
+    boost::shared_ptr<State>    m_state;
+};
+
+// meshes the points of a QSIP as balls; there is a single level of detail
+// and points already shown by another QSIP are left out
+template<class QsipHandle_>
+class QsipLodMesher
+{
+public:
+    QsipLodMesher(QsipHandle_ qsip, CanonicalKeySet *keys, ExactCheckpointPtr checkpoint, QGLWidget *gl)
+        : m_qsip(qsip),
+          m_keys(keys),
+          m_checkpoint(checkpoint),
+          m_gl(gl)
+    {
+    }
+
+    bool operator()(int level, MeshList &meshes, LodMeshCache::MeshInfo &info) const
+    {
+        Q_UNUSED(level);
+
+        // keyed by content, the list of QSIPs differs between
+        // builds with different calculation flags
+        std::string key = m_qsip->to_string();
+
+        std::vector<Qsip_spin_3_Z> points;
+
+        if (!m_checkpoint || !m_checkpoint->loadPoints(key, points))
+        {
+            Spin_qsip_mesh_3_Z mesher(*m_qsip);
+
+            // each point
+            for (size_t point = 0; point != mesher.size_of_points(); ++point)
+            {
+                // evaluate point
+                Qsip_spin_3_Z spin;
+                mesher.mesh_point(spin, point);
+
+                // store canonical points, s0 >= 0
+                if (spin.s0() < 0)
+                    spin = -spin;
+
+                points.push_back(spin);
+            }
+
+            if (m_checkpoint)
+                m_checkpoint->savePoints(key, points);
+        }
+
+        // q and -q give the same canonical point
+        std::vector<Qsip_spin_3_Z> shown;
+
+        for (std::vector<Qsip_spin_3_Z>::const_iterator it = points.begin(); it != points.end(); ++it)
+        {
+            std::ostringstream pointKey;
+            pointKey << std::setprecision(std::numeric_limits<double>::digits10 + 2)
+                     << it->s12() << ' ' << it->s23() << ' ' << it->s31() << ' ' << it->s0();
+
+            if (!m_keys->insert(pointKey.str()))
+                continue;
+
+            shown.push_back(*it);
+            info.include(it->s12(), it->s23(), it->s31());
+        }
+
+        if (shown.empty())
+            return false;
+
+        // the antipodal points are the mirror image of the balls
+        meshes.push_back(MeshPtr(new BallListMesh(m_gl, shown, 0.025, 12, 12)));
+        info.bytes = shown.size() * sizeof(Qsip_spin_3_Z);
+
+        return true;
+    }
+
+private:
+    QsipHandle_                 m_qsip;
+    CanonicalKeySet *           m_keys;
+    ExactCheckpointPtr          m_checkpoint;
+    QGLWidget *                 m_gl;
+};
+
 class ExactConfigurationSpace
     : public ConfigurationSpace
 {
-    typedef Spin_qsip_mesh_3_Z::Spin_3 Spin_3;
-
 public:
     template<class Configuration_, typename InputIterator>
     ExactConfigurationSpace(const ExactConfigurationSpaceTag<Configuration_> &,
@@ -54,9 +297,15 @@ public:
                            bool suppressQsicMeshing,
                            bool suppressQsipMeshing,
                            bool optionViewClipPlane,
+                           ExactCheckpointPtr checkpoint,
+                           MeshingBudgetPtr budget,
                            QGLWidget *gl)
         : ConfigurationSpace(gl),
-          m_optionViewClipPlane(optionViewClipPlane)
+          m_optionViewClipPlane(optionViewClipPlane),
+          m_meshes(gl),
+          m_quadrics(m_meshes.addGroup("quadrics")),
+          m_qsics(m_meshes.addGroup("QSICs")),
+          m_qsips(m_meshes.addGroup("QSIPs", 1))
     {
         typedef Configuration_                                  Configuration;
         //typedef typename Configuration::Parameters              Parameters;
@@ -65,121 +314,89 @@ public:
         // create configuration space for given representation
         GenericRouter<Configuration> *exactRouter = new GenericRouter<Configuration>();
 
-        exactRouter->configuration().create_from_scene(robot_begin, robot_end,
-                                                       obstacle_begin, obstacle_end,
-                                                       parameters);
-
-        // assume that the representation is cell graph
-        const Representation &rep = exactRouter->configuration().rep();
-
-        // prepare
-        typedef typename Representation::Spin_quadric_const_iterator Spin_quadric_const_iterator;
+        // install route executor
+        m_router.reset(exactRouter);
 
-        if (!suppressQuadricMeshing)
+        // the handles are copied into the meshers under the kernel lock,
+        // meshing jobs of other configuration spaces may be running
         {
-            for (Spin_quadric_const_iterator spinQuadricIterator = rep.spin_quadrics_begin();
-                 spinQuadricIterator != rep.spin_quadrics_end(); ++spinQuadricIterator)
-            {
-                Spin_quadric_mesh_3_Z mesher(*spinQuadricIterator);
+            QMutexLocker locker(&kernelMutex());
 
-                double angular_bound = 30;
-                double radius_bound = 0.1;
-                double distance_bound = 0.1;
+            exactRouter->configuration().create_from_scene(robot_begin, robot_end,
+                                                           obstacle_begin, obstacle_end,
+                                                           parameters);
 
-                Mesh_smooth_triangle_list_3_Z_ptr left(new Mesh_smooth_triangle_list_3_Z());
-                Mesh_smooth_triangle_list_3_Z_ptr right(new Mesh_smooth_triangle_list_3_Z());
+            // assume that the representation is cell graph
+            const Representation &rep = exactRouter->configuration().rep();
 
-                mesher.mesh_triangle_soup(std::back_inserter(*left),
-                                          std::back_inserter(*right),
-                                          angular_bound,
-                                          radius_bound,
-                                          distance_bound);
+            // all primitives are meshed coarsely here and refined on demand
+            // while rendering; with a budget the coarse meshes are streamed into
+            // the view, quadrics first, and what is left out is reported
+            typedef typename Representation::Spin_quadric_const_iterator Spin_quadric_const_iterator;
+            typedef typename std::iterator_traits<Spin_quadric_const_iterator>::value_type Spin_quadric;
 
-                // create triangle lists
-                TriangleListMeshPtr leftMesh(new TriangleListMesh(m_gl, left));
-                TriangleListMeshPtr rightMesh(new TriangleListMesh(m_gl, right));
+            typedef typename Representation::Qsic_const_iterator Qsic_const_iterator;
+            typedef typename Representation::Qsic_handle Qsic_handle;
 
-                // store triangle lists
-                m_triangleListMeshPairs.push_back(std::make_pair(leftMesh, rightMesh));
-            }
-        }
+            typedef typename Representation::Qsip_const_iterator Qsip_const_iterator;
+            typedef typename Representation::Qsip_handle Qsip_handle;
 
-        // QSICs
-        typedef typename Representation::Qsic_const_iterator Qsic_const_iterator;
-        typedef typename Representation::Qsic_handle Qsic_handle;
+            // proportional quadrics and identical QSICs are meshed once
+            std::set<std::string> quadricKeys;
 
-        if (!suppressQsicMeshing)
-        {
-            for (Qsic_const_iterator qsicIterator = rep.qsics_begin();
-                 qsicIterator != rep.qsics_end(); ++qsicIterator)
+            if (!suppressQuadricMeshing)
             {
-                Qsic_handle qsic = *qsicIterator;
-                Spin_qsic_mesh_3_Z mesher(*qsic);
-
-                // each component
-                for (size_t component = 0; component != mesher.size_of_components(); ++component)
+                for (Spin_quadric_const_iterator spinQuadricIterator = rep.spin_quadrics_begin();
+                     spinQuadricIterator != rep.spin_quadrics_end(); ++spinQuadricIterator)
                 {
-                    // FIXME: if the component is not one dimensional, ignore it
-                    if (qsic->component_dimension(component) != 1)
-                        continue;
-
-                    // evaluate curve
-                    Qsic_spin_list_3_Z_ptr spinList(new Qsic_spin_list_3_Z());
-
-                    double radiusBound = 0.1;
+                    std::string key = canonicalFormKey(spinQuadricIterator->to_string());
 
-                    mesher.mesh_component(*spinList, component, radiusBound);
-
-                    Qsic_spin_list_3_Z_ptr negSpinList(new Qsic_spin_list_3_Z());
-
-                    foreach (const Qsic_spin_3_Z &spin, *spinList)
-                        negSpinList->push_back(-spin);
-
-                    // create poly cones
-                    PolyConeMeshPtr positivePolyCone(new PolyConeMesh(m_gl, spinList, 0.02, 12));
-                    PolyConeMeshPtr negativePolyCone(new PolyConeMesh(m_gl, negSpinList, 0.02, 12));
+                    if (!quadricKeys.insert(key).second)
+                        continue;
 
-                    // store poly cones
-                    m_polyConeMeshPairs.push_back(std::make_pair(positivePolyCone, negativePolyCone));
+                    m_meshes.add(m_quadrics, SpinQuadricLodMesher<Spin_quadric>(&*spinQuadricIterator, key, checkpoint, m_gl));
                 }
             }
-        }
-
-        // QSIPs
-        typedef typename Representation::Qsip_const_iterator Qsip_const_iterator;
-        typedef typename Representation::Qsip_handle Qsip_handle;
 
-        if (!suppressQsipMeshing)
-        {
-            m_pointMesh.reset(new BallMesh(gl, 0.025, 12, 12));
-
-            for (Qsip_const_iterator qsipIterator = rep.qsips_begin();
-                 qsipIterator != rep.qsips_end(); ++qsipIterator)
+            if (!suppressQsicMeshing)
             {
-                Qsip_handle qsip = *qsipIterator;
-                Spin_qsip_mesh_3_Z mesher(*qsip);
-
-                // each component
-                for (size_t index = 0; index != mesher.size_of_points(); ++index)
+                for (Qsic_const_iterator qsicIterator = rep.qsics_begin();
+                     qsicIterator != rep.qsics_end(); ++qsicIterator)
                 {
-                    // evaluate point
-                    Spin_3 point;
-                    mesher.mesh_point(point, index);
+                    m_meshes.add(m_qsics, QsicLodMesher<Qsic_handle>(*qsicIterator, &m_qsicKeys, checkpoint, m_gl));
+                }
+            }
 
-                    // store points
-                    m_points.push_back(point);
+            if (!suppressQsipMeshing)
+            {
+                for (Qsip_const_iterator qsipIterator = rep.qsips_begin();
+                     qsipIterator != rep.qsips_end(); ++qsipIterator)
+                {
+                    m_meshes.add(m_qsips, QsipLodMesher<Qsip_handle>(*qsipIterator, &m_qsipKeys, checkpoint, m_gl));
                 }
             }
         }
 
-        // install route executor
-        m_router.reset(exactRouter);
+        if (budget)
+        {
+            m_meshes.setBuildBudget(budget);
+            m_meshes.startCoarsest();
+        }
+        else
+        {
+            m_meshes.meshCoarsest();
+        }
     }
 
     ExactConfigurationSpace(
             QDataStream &stream,
             QGLWidget *gl)
-        : ConfigurationSpace(gl)
+        : ConfigurationSpace(gl),
+          m_optionViewClipPlane(false),
+          m_meshes(gl),
+          m_quadrics(m_meshes.addGroup("quadrics")),
+          m_qsics(m_meshes.addGroup("QSICs")),
+          m_qsips(m_meshes.addGroup("QSIPs", 1))
     {
         Q_UNUSED(stream);
 /*
@@ -219,44 +436,42 @@ public:
         if (m_optionViewClipPlane)
             enableViewClipPlane();
 
+        // level of detail follows the camera distance
+        int level = LodMeshCache::levelForView();
+
+        m_meshes.beginFrame();
+
         Material::setDiffuseSpecularShininess(QColor(238, 144, 20));
 
         // render spin quadrics
-        for (TriangleListMeshPairs::iterator triangleListMeshIterator = m_triangleListMeshPairs.begin();
-             triangleListMeshIterator != m_triangleListMeshPairs.end(); ++triangleListMeshIterator)
-        {
-            triangleListMeshIterator->first->render();
-            triangleListMeshIterator->second->render();
-        }
+        m_meshes.render(m_quadrics, level);
 
+        // render poly cones, s0 >= 0
         Material::setDiffuseSpecularShininess(QColor(51, 147, 41));
 
-        // render poly cones
-        for (PolyConeMeshPairs::iterator polyConeIterator = m_polyConeMeshPairs.begin();
-             polyConeIterator != m_polyConeMeshPairs.end(); ++polyConeIterator)
-        {
-            polyConeIterator->first->render();
-            polyConeIterator->second->render();
-        }
+        m_meshes.render(m_qsics, level);
+
+        // render poly cones, s0 < 0; tubes taper by |s0|, so the sign is
+        // shown by the color only
+        Material::setDiffuseSpecularShininess(QColor(41, 147, 121));
 
-        // render balls
+        enableAntipodalMirror();
+        m_meshes.render(m_qsics, level);
+        disableAntipodalMirror();
+
+        // render balls, s0 >= 0
         Material::setDiffuseSpecularShininess(QColor(255, 127, 0));
 
-        for (Points::iterator pointsIterator = m_points.begin();
-             pointsIterator != m_points.end(); ++pointsIterator)
-        {
-            if (pointsIterator->s0() >= 0)
-                m_pointMesh->renderTranslated(pointsIterator->s12(), pointsIterator->s23(), pointsIterator->s31());
-        }
+        m_meshes.render(m_qsips, level);
 
+        // render balls, s0 < 0
         Material::setDiffuseSpecularShininess(QColor(127, 255, 0));
 
-        for (Points::iterator pointsIterator = m_points.begin();
-             pointsIterator != m_points.end(); ++pointsIterator)
-        {
-            if (pointsIterator->s0() < 0)
-                m_pointMesh->renderTranslated(pointsIterator->s12(), pointsIterator->s23(), pointsIterator->s31());
-        }
+        enableAntipodalMirror();
+        m_meshes.render(m_qsips, level);
+        disableAntipodalMirror();
+
+        m_meshes.endFrame();
 
         if (m_optionViewClipPlane)
             disableViewClipPlane();
@@ -294,20 +509,35 @@ public:
         return false;
     }
 
+    // primitives near the route are refined first
+    void setFocusRoute(RoutePtr route)
+    {
+        std::vector<QVector3D> points;
+
+        for (int i = 0; i <= NUMBER_OF_FOCUS_SAMPLES; ++i)
+        {
+            QQuaternion quaternion = route->evaluate(double(i) / double(NUMBER_OF_FOCUS_SAMPLES));
+            points.push_back(QVector3D(-quaternion.z() /*e12*/, -quaternion.x() /*e23*/, -quaternion.y() /*e31*/));
+        }
+
+        m_meshes.setFocus(points);
+    }
+
 private:
-    typedef std::vector<std::pair<TriangleListMeshPtr, TriangleListMeshPtr> > TriangleListMeshPairs;
-    typedef std::vector<std::pair<PolyConeMeshPtr, PolyConeMeshPtr> > PolyConeMeshPairs;
-    typedef std::vector<Spin_3> Points;
+    static const int NUMBER_OF_FOCUS_SAMPLES = 100;
 
     // options
     bool                        m_optionViewClipPlane;
 
-    // visible data
-    TriangleListMeshPairs       m_triangleListMeshPairs;
-    PolyConeMeshPairs           m_polyConeMeshPairs;
-    Points                      m_points;
+    // visible data, keys outlive the meshing jobs of the cache
+    CanonicalKeySet             m_qsicKeys;
+    CanonicalKeySet             m_qsipKeys;
+    LodMeshCache                m_meshes;
 
-    boost::scoped_ptr<BallMesh> m_pointMesh;
+    // groups of the cache
+    int                         m_quadrics;
+    int                         m_qsics;
+    int                         m_qsips;
 };
 
 typedef boost::shared_ptr<ExactConfigurationSpace> ExactConfigurationSpacePtr;
@@ -0,0 +1,315 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "exactsceneconverter.h"
+#include <QByteArray>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <cassert>
+
+namespace // anonymous
+{
+Z integerPower(int base, int exponent)
+{
+    assert(exponent >= 0);
+
+    Z result(1);
+    Z square(base);
+
+    while (exponent)
+    {
+        if (exponent & 1)
+            result = result * square;
+
+        exponent >>= 1;
+
+        if (exponent)
+            square = square * square;
+    }
+
+    return result;
+}
+
+int countFactors(Z value, int factor, int limit)
+{
+    int count = 0;
+
+    if (value == Z(0))
+        return limit;
+
+    while (count < limit && value % Z(factor) == Z(0))
+    {
+        value = value / Z(factor);
+        ++count;
+    }
+
+    return count;
+}
+
+// multiply by 2^powerOfTwo * 5^powerOfFive, negative powers must divide exactly
+Z scaleByPowers(const Z &value, int powerOfTwo, int powerOfFive)
+{
+    Z numerator = value;
+    Z denominator(1);
+
+    if (powerOfTwo > 0)
+        numerator = numerator * integerPower(2, powerOfTwo);
+    else if (powerOfTwo < 0)
+        denominator = denominator * integerPower(2, -powerOfTwo);
+
+    if (powerOfFive > 0)
+        numerator = numerator * integerPower(5, powerOfFive);
+    else if (powerOfFive < 0)
+        denominator = denominator * integerPower(5, -powerOfFive);
+
+    return denominator == Z(1) ? numerator : numerator / denominator;
+}
+
+int bitLength(Z value)
+{
+    int bits = 0;
+
+    while (value > Z(0))
+    {
+        value = value / Z(2);
+        ++bits;
+    }
+
+    return bits;
+}
+} // namespace anonymous
+
+void decimalToZ(const QDecimal &decimal, Z &mantissa, int &exponent)
+{
+    if (decimal.isFast())
+    {
+        qint64 value = decimal.mantissa();
+        exponent = value ? decimal.exponent() : 0;
+
+        while (value && value % 10 == 0)
+        {
+            value /= 10;
+            ++exponent;
+        }
+
+        mantissa = longLongToZ(value);
+        return;
+    }
+
+    // textual form is [-]digits[.digits][E[+-]digits]
+    QByteArray buffer = decimal.toString();
+    const char *text = buffer.constData();
+
+    bool negative = false;
+
+    if (*text == '-' || *text == '+')
+        negative = (*text++ == '-');
+
+    std::string digits;
+    int fractionDigits = 0;
+    bool fraction = false;
+
+    for (; *text; ++text)
+    {
+        if (*text >= '0' && *text <= '9')
+        {
+            // leading zeros would make an octal number for some integer types
+            if (!digits.empty() || *text != '0')
+                digits.push_back(*text);
+
+            if (fraction)
+                ++fractionDigits;
+        }
+        else if (*text == '.')
+        {
+            fraction = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    exponent = -fractionDigits;
+
+    if (*text == 'E' || *text == 'e')
+        exponent += std::atoi(text + 1);
+
+    // drop trailing zeros
+    while (!digits.empty() && digits[digits.size() - 1] == '0')
+    {
+        digits.resize(digits.size() - 1);
+        ++exponent;
+    }
+
+    if (digits.empty())
+    {
+        mantissa = Z(0);
+        exponent = 0;
+        return;
+    }
+
+    if (negative)
+        digits.insert(digits.begin(), '-');
+
+    stringToZ(digits.c_str(), mantissa);
+}
+
+ExactSceneConverter::ExactSceneConverter()
+    : m_truncated(false),
+      m_powerOfTwo(0),
+      m_powerOfFive(0),
+      m_gcd(1),
+      m_maximumBitLength(0)
+{
+}
+
+size_t ExactSceneConverter::add(const QDecimal &decimal)
+{
+    m_decimals.push_back(parse(decimal));
+    return m_decimals.size() - 1;
+}
+
+void ExactSceneConverter::convert()
+{
+    // smallest common denominator
+    m_powerOfTwo = 0;
+    m_powerOfFive = 0;
+
+    for (std::vector<Decimal>::const_iterator it = m_decimals.begin(); it != m_decimals.end(); ++it)
+    {
+        if (it->exponent >= 0)
+            continue;
+
+        m_powerOfTwo = std::max(m_powerOfTwo, -it->exponent - it->powersOfTwo);
+        m_powerOfFive = std::max(m_powerOfFive, -it->exponent - it->powersOfFive);
+    }
+
+    // scale to integers
+    m_values.clear();
+    m_values.reserve(m_decimals.size());
+
+    m_gcd = Z(0);
+
+    for (std::vector<Decimal>::const_iterator it = m_decimals.begin(); it != m_decimals.end(); ++it)
+    {
+        m_values.push_back(scaleByPowers(it->mantissa, m_powerOfTwo + it->exponent, m_powerOfFive + it->exponent));
+
+        if (m_gcd != Z(1))
+            m_gcd = greatestCommonDivisor(m_gcd, absolute(m_values.back()));
+    }
+
+    // reduce by common divisor
+    if (m_gcd == Z(0))
+        m_gcd = Z(1);
+
+    Z maximumValue(0);
+
+    for (std::vector<Z>::iterator it = m_values.begin(); it != m_values.end(); ++it)
+    {
+        if (m_gcd != Z(1))
+            *it = *it / m_gcd;
+
+        Z absoluteValue = absolute(*it);
+
+        if (maximumValue < absoluteValue)
+            maximumValue = absoluteValue;
+    }
+
+    m_maximumBitLength = bitLength(maximumValue);
+}
+
+const Z &ExactSceneConverter::value(size_t index) const
+{
+    assert(index < m_values.size());
+    return m_values[index];
+}
+
+size_t ExactSceneConverter::numberOfValues() const
+{
+    return m_values.size();
+}
+
+bool ExactSceneConverter::isTruncated() const
+{
+    return m_truncated;
+}
+
+int ExactSceneConverter::powerOfTwo() const
+{
+    return m_powerOfTwo;
+}
+
+int ExactSceneConverter::powerOfFive() const
+{
+    return m_powerOfFive;
+}
+
+const Z &ExactSceneConverter::gcd() const
+{
+    return m_gcd;
+}
+
+int ExactSceneConverter::maximumBitLength() const
+{
+    return m_maximumBitLength;
+}
+
+ExactSceneConverter::Decimal ExactSceneConverter::parse(const QDecimal &decimal)
+{
+    Decimal result;
+    result.powersOfTwo = 0;
+    result.powersOfFive = 0;
+
+    decimalToZ(decimal, result.mantissa, result.exponent);
+
+    if (result.mantissa == Z(0))
+        return result;
+
+    // truncate too many fraction digits
+    if (result.exponent < -MAXIMUM_FRACTION_DIGITS)
+    {
+        m_truncated = true;
+
+        result.mantissa = result.mantissa / integerPower(10, -MAXIMUM_FRACTION_DIGITS - result.exponent);
+        result.exponent = -MAXIMUM_FRACTION_DIGITS;
+
+        if (result.mantissa == Z(0))
+        {
+            result.exponent = 0;
+            return result;
+        }
+
+        while (result.mantissa % Z(10) == Z(0))
+        {
+            result.mantissa = result.mantissa / Z(10);
+            ++result.exponent;
+        }
+    }
+
+    // factors which cancel with the decimal denominator
+    if (result.exponent < 0)
+    {
+        result.powersOfTwo = countFactors(absolute(result.mantissa), 2, -result.exponent);
+        result.powersOfFive = countFactors(absolute(result.mantissa), 5, -result.exponent);
+    }
+
+    return result;
+}
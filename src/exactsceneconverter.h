@@ -0,0 +1,92 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef EXACTSCENECONVERTER_H
+#define EXACTSCENECONVERTER_H
+
+#include "kernel.h"
+#include "qdecimal.h"
+#include <vector>
+
+// exact mantissa * 10^exponent of a decimal; the mantissa has no trailing
+// zeros and zero has exponent 0
+//
+// decimals on the fast path are read directly, the text form is parsed
+// only for the others
+void decimalToZ(const QDecimal &decimal, Z &mantissa, int &exponent);
+
+// converts decimal scene coordinates to integers for the exact kernel
+//
+// all coordinates are multiplied by the smallest 2^a * 5^b that makes
+// every one of them integral, and the results are divided by their
+// common gcd; a uniform scale of the scene about the origin does not
+// change its configuration space, so the integers stay as small as
+// possible without changing the result
+class ExactSceneConverter
+{
+public:
+    ExactSceneConverter();
+
+    // collect a coordinate, returns its index
+    size_t              add(const QDecimal &decimal);
+
+    // compute the common scale and all integers
+    void                convert();
+
+    // valid after convert()
+    const Z &           value(size_t index) const;
+
+    size_t              numberOfValues() const;
+
+    // true if some coordinates had more fraction digits than allowed
+    bool                isTruncated() const;
+
+    // scale factor is 2^powerOfTwo * 5^powerOfFive / gcd
+    int                 powerOfTwo() const;
+    int                 powerOfFive() const;
+    const Z &           gcd() const;
+
+    // bit length of the largest absolute value
+    int                 maximumBitLength() const;
+
+    static const int MAXIMUM_FRACTION_DIGITS = 32;
+
+private:
+    // decimal value is mantissa * 10^exponent
+    struct Decimal
+    {
+        Z       mantissa;
+        int     exponent;
+        int     powersOfTwo;    // factors of 2 in mantissa, up to -exponent
+        int     powersOfFive;   // factors of 5 in mantissa, up to -exponent
+    };
+
+    std::vector<Decimal>    m_decimals;
+    std::vector<Z>          m_values;
+
+    bool                    m_truncated;
+    int                     m_powerOfTwo;
+    int                     m_powerOfFive;
+    Z                       m_gcd;
+    int                     m_maximumBitLength;
+
+    Decimal                 parse(const QDecimal &decimal);
+};
+
+#endif // EXACTSCENECONVERTER_H
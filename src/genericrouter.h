@@ -21,6 +21,8 @@
 #define GENERICROUTER_H
 
 #include "configurationspace.h"
+#include "kernel.h"
+#include <QMutexLocker>
 #include <QQuaternion>
 
 template<class Configuration_>
@@ -72,6 +74,8 @@ public:
 
     virtual RoutePtr        findRoute(const QQuaternion &begin, const QQuaternion &end)
     {
+        QMutexLocker locker(&kernelMutex());
+
         ConfigurationRoute route = m_configuration.find_route(quaternionToSample(begin),
                                                               quaternionToSample(end));
 
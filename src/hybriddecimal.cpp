@@ -0,0 +1,484 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "hybriddecimal.h"
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+
+namespace // anonymous
+{
+// 18 digits, so sums of two mantissas never overflow
+const qint64 MAXIMUM_MANTISSA = Q_INT64_C(999999999999999999);
+const int MAXIMUM_DIGITS = 18;
+
+// far below the decNumber limits
+const int MAXIMUM_EXPONENT = 100000;
+
+// doubles represent every integer and power of ten below these exactly
+const qint64 MAXIMUM_EXACT_DOUBLE_MANTISSA = Q_INT64_C(1) << 53;
+const int MAXIMUM_EXACT_DOUBLE_EXPONENT = 22;
+
+const qint64 POWERS_OF_TEN[MAXIMUM_DIGITS + 1] =
+{
+    Q_INT64_C(1),
+    Q_INT64_C(10),
+    Q_INT64_C(100),
+    Q_INT64_C(1000),
+    Q_INT64_C(10000),
+    Q_INT64_C(100000),
+    Q_INT64_C(1000000),
+    Q_INT64_C(10000000),
+    Q_INT64_C(100000000),
+    Q_INT64_C(1000000000),
+    Q_INT64_C(10000000000),
+    Q_INT64_C(100000000000),
+    Q_INT64_C(1000000000000),
+    Q_INT64_C(10000000000000),
+    Q_INT64_C(100000000000000),
+    Q_INT64_C(1000000000000000),
+    Q_INT64_C(10000000000000000),
+    Q_INT64_C(100000000000000000),
+    Q_INT64_C(1000000000000000000)
+};
+
+const double DOUBLE_POWERS_OF_TEN[MAXIMUM_EXACT_DOUBLE_EXPONENT + 1] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+inline qint64 absolute(qint64 value)
+{
+    return value < 0 ? -value : value;
+}
+
+inline bool isExponentInRange(qint64 exponent)
+{
+    return exponent >= -MAXIMUM_EXPONENT && exponent <= MAXIMUM_EXPONENT;
+}
+
+// mantissa * 10^digits, fails if the result is too long
+bool scaleUp(qint64 mantissa, int digits, qint64 &result)
+{
+    if (!mantissa)
+    {
+        result = 0;
+        return true;
+    }
+
+    if (digits > MAXIMUM_DIGITS || absolute(mantissa) > MAXIMUM_MANTISSA / POWERS_OF_TEN[digits])
+        return false;
+
+    result = mantissa * POWERS_OF_TEN[digits];
+    return true;
+}
+
+// decNumber text, [-]digits[.digits][E[+-]digits]; special values and
+// negative zero stay on the slow path
+bool parseFast(const char *text, qint64 &mantissa, int &exponent)
+{
+    bool negative = false;
+
+    if (*text == '-' || *text == '+')
+        negative = (*text++ == '-');
+
+    qint64 digits = 0;
+    int numberOfDigits = 0;
+    int fractionDigits = 0;
+    bool fraction = false;
+    bool anyDigit = false;
+
+    for (; *text; ++text)
+    {
+        if (*text >= '0' && *text <= '9')
+        {
+            anyDigit = true;
+
+            if (fraction)
+                ++fractionDigits;
+
+            if (!digits && *text == '0')
+                continue;
+
+            if (++numberOfDigits > MAXIMUM_DIGITS)
+                return false;
+
+            digits = digits * 10 + (*text - '0');
+        }
+        else if (*text == '.' && !fraction)
+        {
+            fraction = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (!anyDigit || (negative && !digits))
+        return false;
+
+    qint64 fullExponent = -fractionDigits;
+
+    if (*text == 'E' || *text == 'e')
+    {
+        char *end;
+        long value = std::strtol(text + 1, &end, 10);
+
+        if (end == text + 1 || value < -MAXIMUM_EXPONENT || value > MAXIMUM_EXPONENT)
+            return false;
+
+        fullExponent += value;
+        text = end;
+    }
+
+    if (*text || !isExponentInRange(fullExponent))
+        return false;
+
+    mantissa = negative ? -digits : digits;
+    exponent = static_cast<int>(fullExponent);
+    return true;
+}
+
+// coefficient and exponent of a decNumber; special values and negative
+// zero stay on the slow path
+bool decomposeFast(const QDecNumber &value, qint64 &mantissa, int &exponent)
+{
+    const decNumber *number = value.data();
+
+    if (decNumberIsSpecial(number) || (decNumberIsNegative(number) && decNumberIsZero(number)))
+        return false;
+
+    if (number->digits > MAXIMUM_DIGITS || !isExponentInRange(number->exponent))
+        return false;
+
+    uint8_t digits[MAXIMUM_DIGITS];
+    decNumberGetBCD(number, digits);
+
+    qint64 coefficient = 0;
+
+    for (int i = 0; i < number->digits; ++i)
+        coefficient = coefficient * 10 + digits[i];
+
+    mantissa = decNumberIsNegative(number) ? -coefficient : coefficient;
+    exponent = number->exponent;
+    return true;
+}
+
+// decNumber to-scientific-string
+QByteArray formatFast(qint64 mantissa, int exponent)
+{
+    char digits[32];
+    int length = std::sprintf(digits, "%lld", static_cast<long long>(absolute(mantissa)));
+    int adjusted = exponent + length - 1;
+
+    std::string text;
+
+    if (mantissa < 0)
+        text.push_back('-');
+
+    if (exponent <= 0 && adjusted >= -6)
+    {
+        if (!exponent)
+        {
+            text.append(digits, static_cast<size_t>(length));
+        }
+        else if (length > -exponent)
+        {
+            text.append(digits, static_cast<size_t>(length + exponent));
+            text.push_back('.');
+            text.append(digits + length + exponent);
+        }
+        else
+        {
+            text.append("0.");
+            text.append(static_cast<size_t>(-exponent - length), '0');
+            text.append(digits, static_cast<size_t>(length));
+        }
+    }
+    else
+    {
+        text.push_back(digits[0]);
+
+        if (length > 1)
+        {
+            text.push_back('.');
+            text.append(digits + 1);
+        }
+
+        char buffer[16];
+        std::sprintf(buffer, "E%+d", adjusted);
+        text.append(buffer);
+    }
+
+    return QByteArray(text.data(), static_cast<int>(text.size()));
+}
+} // namespace anonymous
+
+HybridDecimal::HybridDecimal()
+    : m_mantissa(0),
+      m_exponent(0)
+{
+}
+
+HybridDecimal::HybridDecimal(int value)
+    : m_mantissa(value),
+      m_exponent(0)
+{
+}
+
+HybridDecimal::HybridDecimal(const QDecNumber &value)
+    : m_mantissa(0),
+      m_exponent(0)
+{
+    setSlow(value);
+}
+
+HybridDecimal::HybridDecimal(qint64 mantissa, int exponent)
+    : m_mantissa(0),
+      m_exponent(0)
+{
+    if (absolute(mantissa) <= MAXIMUM_MANTISSA && exponent >= -MAXIMUM_EXPONENT && exponent <= MAXIMUM_EXPONENT)
+    {
+        setFast(mantissa, exponent);
+    }
+    else
+    {
+        char text[48];
+        std::sprintf(text, "%lldE%d", static_cast<long long>(mantissa), exponent);
+        fromString(text);
+    }
+}
+
+HybridDecimal &HybridDecimal::fromString(const char *text)
+{
+    qint64 mantissa;
+    int exponent;
+
+    if (parseFast(text, mantissa, exponent))
+    {
+        setFast(mantissa, exponent);
+    }
+    else
+    {
+        QDecNumber value;
+        value.fromString(text);
+
+        m_slow.reset(new QDecNumber(value));
+    }
+
+    return *this;
+}
+
+QByteArray HybridDecimal::toString() const
+{
+    return m_slow ? m_slow->toString() : formatFast(m_mantissa, m_exponent);
+}
+
+double HybridDecimal::toDouble() const
+{
+    if (m_slow)
+        return m_slow->toDouble();
+
+    // both operands exact, so the result is correctly rounded
+    if (absolute(m_mantissa) <= MAXIMUM_EXACT_DOUBLE_MANTISSA && m_exponent >= -MAXIMUM_EXACT_DOUBLE_EXPONENT && m_exponent <= MAXIMUM_EXACT_DOUBLE_EXPONENT)
+    {
+        double mantissa = static_cast<double>(m_mantissa);
+
+        return m_exponent < 0 ? mantissa / DOUBLE_POWERS_OF_TEN[-m_exponent]
+                              : mantissa * DOUBLE_POWERS_OF_TEN[m_exponent];
+    }
+
+    return std::strtod(toString().constData(), 0);
+}
+
+QDecNumber HybridDecimal::toDecNumber() const
+{
+    if (m_slow)
+        return *m_slow;
+
+    QDecNumber value;
+    value.fromString(toString().constData());
+    return value;
+}
+
+bool HybridDecimal::isFast() const
+{
+    return !m_slow;
+}
+
+qint64 HybridDecimal::mantissa() const
+{
+    return m_mantissa;
+}
+
+int HybridDecimal::exponent() const
+{
+    return m_exponent;
+}
+
+HybridDecimal HybridDecimal::abs() const
+{
+    HybridDecimal result;
+
+    if (m_slow)
+        result.setSlow(m_slow->abs());
+    else
+        result.setFast(absolute(m_mantissa), m_exponent);
+
+    return result;
+}
+
+HybridDecimal HybridDecimal::operator -() const
+{
+    HybridDecimal result;
+
+    if (m_slow || !m_mantissa)
+        result.setSlow(QDecNumber(0) - toDecNumber());
+    else
+        result.setFast(-m_mantissa, m_exponent);
+
+    return result;
+}
+
+HybridDecimal &HybridDecimal::operator +=(const HybridDecimal &other)
+{
+    if (!m_slow && !other.m_slow)
+    {
+        // align to the smaller exponent
+        int exponent = qMin(m_exponent, other.m_exponent);
+        qint64 left, right;
+
+        if (scaleUp(m_mantissa, m_exponent - exponent, left) &&
+            scaleUp(other.m_mantissa, other.m_exponent - exponent, right) &&
+            absolute(left + right) <= MAXIMUM_MANTISSA)
+        {
+            setFast(left + right, exponent);
+            return *this;
+        }
+    }
+
+    setSlow(toDecNumber() + other.toDecNumber());
+    return *this;
+}
+
+HybridDecimal &HybridDecimal::operator -=(const HybridDecimal &other)
+{
+    if (!m_slow && !other.m_slow)
+    {
+        int exponent = qMin(m_exponent, other.m_exponent);
+        qint64 left, right;
+
+        if (scaleUp(m_mantissa, m_exponent - exponent, left) &&
+            scaleUp(other.m_mantissa, other.m_exponent - exponent, right) &&
+            absolute(left - right) <= MAXIMUM_MANTISSA)
+        {
+            setFast(left - right, exponent);
+            return *this;
+        }
+    }
+
+    setSlow(toDecNumber() - other.toDecNumber());
+    return *this;
+}
+
+HybridDecimal &HybridDecimal::operator *=(const HybridDecimal &other)
+{
+    if (!m_slow && !other.m_slow)
+    {
+        qint64 exponent = static_cast<qint64>(m_exponent) + other.m_exponent;
+
+        if (!other.m_mantissa || absolute(m_mantissa) <= MAXIMUM_MANTISSA / absolute(other.m_mantissa))
+        {
+            // the sign of a zero product is kept by decNumber
+            if ((m_mantissa && other.m_mantissa) || (m_mantissa >= 0 && other.m_mantissa >= 0))
+            {
+                if (isExponentInRange(exponent))
+                {
+                    setFast(m_mantissa * other.m_mantissa, static_cast<int>(exponent));
+                    return *this;
+                }
+            }
+        }
+    }
+
+    setSlow(toDecNumber() * other.toDecNumber());
+    return *this;
+}
+
+HybridDecimal &HybridDecimal::operator /=(const HybridDecimal &other)
+{
+    // only exact quotients have the ideal exponent
+    if (!m_slow && !other.m_slow && other.m_mantissa && !(m_mantissa % other.m_mantissa))
+    {
+        qint64 exponent = static_cast<qint64>(m_exponent) - other.m_exponent;
+
+        if (isExponentInRange(exponent) && (m_mantissa || other.m_mantissa > 0))
+        {
+            setFast(m_mantissa / other.m_mantissa, static_cast<int>(exponent));
+            return *this;
+        }
+    }
+
+    setSlow(toDecNumber() / other.toDecNumber());
+    return *this;
+}
+
+int HybridDecimal::compare(const HybridDecimal &other) const
+{
+    if (m_slow || other.m_slow)
+    {
+        QDecNumber left = toDecNumber();
+        QDecNumber right = other.toDecNumber();
+
+        return left < right ? -1 : (left > right ? 1 : 0);
+    }
+
+    qint64 left = m_mantissa;
+    qint64 right = other.m_mantissa;
+
+    // a mantissa which cannot be scaled is the larger in magnitude
+    if (m_exponent > other.m_exponent && !scaleUp(m_mantissa, m_exponent - other.m_exponent, left))
+        return m_mantissa > 0 ? 1 : -1;
+
+    if (other.m_exponent > m_exponent && !scaleUp(other.m_mantissa, other.m_exponent - m_exponent, right))
+        return other.m_mantissa > 0 ? -1 : 1;
+
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+void HybridDecimal::setFast(qint64 mantissa, int exponent)
+{
+    m_mantissa = mantissa;
+    m_exponent = exponent;
+    m_slow.reset();
+}
+
+void HybridDecimal::setSlow(const QDecNumber &value)
+{
+    // go back to the fast path whenever the result fits
+    qint64 mantissa;
+    int exponent;
+
+    if (decomposeFast(value, mantissa, exponent))
+        setFast(mantissa, exponent);
+    else
+        m_slow.reset(new QDecNumber(value));
+}
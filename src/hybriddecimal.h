@@ -0,0 +1,126 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef HYBRIDDECIMAL_H
+#define HYBRIDDECIMAL_H
+
+#include <qdecimal/QDecNumber.hh>
+#include <QByteArray>
+#include <QtGlobal>
+#include <boost/shared_ptr.hpp>
+
+// a decimal kept as a 64-bit mantissa and a decimal exponent while it fits,
+// and as a QDecNumber otherwise
+//
+// exponents follow decNumber, so results and their text form are the same
+// as with QDecNumber alone; only inexact division always takes the slow path
+class HybridDecimal
+{
+public:
+    HybridDecimal();
+    HybridDecimal(int value);
+    explicit HybridDecimal(const QDecNumber &value);
+
+    // mantissa * 10^exponent
+    HybridDecimal(qint64 mantissa, int exponent);
+
+    HybridDecimal &     fromString(const char *text);
+    QByteArray          toString() const;
+    double              toDouble() const;
+    QDecNumber          toDecNumber() const;
+
+    // the value is mantissa() * 10^exponent() on the fast path, both
+    // are undefined on the slow path
+    bool                isFast() const;
+    qint64              mantissa() const;
+    int                 exponent() const;
+
+    HybridDecimal       abs() const;
+    HybridDecimal       operator -() const;
+
+    HybridDecimal &     operator +=(const HybridDecimal &other);
+    HybridDecimal &     operator -=(const HybridDecimal &other);
+    HybridDecimal &     operator *=(const HybridDecimal &other);
+    HybridDecimal &     operator /=(const HybridDecimal &other);
+
+    // negative, zero or positive as this is less, equal or greater
+    int                 compare(const HybridDecimal &other) const;
+
+private:
+    qint64                          m_mantissa;
+    int                             m_exponent;
+
+    // set only on the slow path
+    boost::shared_ptr<QDecNumber>   m_slow;
+
+    void                setFast(qint64 mantissa, int exponent);
+    void                setSlow(const QDecNumber &value);
+};
+
+inline HybridDecimal operator +(HybridDecimal left, const HybridDecimal &right)
+{
+    return left += right;
+}
+
+inline HybridDecimal operator -(HybridDecimal left, const HybridDecimal &right)
+{
+    return left -= right;
+}
+
+inline HybridDecimal operator *(HybridDecimal left, const HybridDecimal &right)
+{
+    return left *= right;
+}
+
+inline HybridDecimal operator /(HybridDecimal left, const HybridDecimal &right)
+{
+    return left /= right;
+}
+
+inline bool operator ==(const HybridDecimal &left, const HybridDecimal &right)
+{
+    return left.compare(right) == 0;
+}
+
+inline bool operator !=(const HybridDecimal &left, const HybridDecimal &right)
+{
+    return left.compare(right) != 0;
+}
+
+inline bool operator <(const HybridDecimal &left, const HybridDecimal &right)
+{
+    return left.compare(right) < 0;
+}
+
+inline bool operator >(const HybridDecimal &left, const HybridDecimal &right)
+{
+    return left.compare(right) > 0;
+}
+
+inline bool operator <=(const HybridDecimal &left, const HybridDecimal &right)
+{
+    return left.compare(right) <= 0;
+}
+
+inline bool operator >=(const HybridDecimal &left, const HybridDecimal &right)
+{
+    return left.compare(right) >= 0;
+}
+
+#endif // HYBRIDDECIMAL_H
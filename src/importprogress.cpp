@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "importprogress.h"
+#include <QtGlobal>
+
+ImportProgress::ImportProgress()
+    : m_value(0),
+      m_cancelled(0)
+{
+}
+
+int ImportProgress::value() const
+{
+    return qBound(0, m_value.load(), static_cast<int>(MAXIMUM));
+}
+
+void ImportProgress::setValue(int value)
+{
+    m_value.store(qBound(0, value, static_cast<int>(MAXIMUM)));
+}
+
+void ImportProgress::advance(int delta)
+{
+    m_value.fetchAndAddRelaxed(delta);
+}
+
+void ImportProgress::cancel()
+{
+    m_cancelled.store(1);
+}
+
+bool ImportProgress::isCancelled() const
+{
+    return m_cancelled.load() != 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef IMPORTPROGRESS_H
+#define IMPORTPROGRESS_H
+
+#include <QAtomicInt>
+#include <boost/noncopyable.hpp>
+
+// progress of one background task such as a file being imported, written
+// by the working thread and read by the GUI; the GUI may also ask the task
+// to stop
+class ImportProgress
+    : private boost::noncopyable
+{
+public:
+    static const int MAXIMUM = 1000;
+
+    ImportProgress();
+
+    // done part, 0 to MAXIMUM
+    int                 value() const;
+    void                setValue(int value);
+
+    // safe to call from several workers of one loader
+    void                advance(int delta);
+
+    // loaders check this between stages and give up with a failure
+    void                cancel();
+    bool                isCancelled() const;
+
+private:
+    QAtomicInt          m_value;
+    QAtomicInt          m_cancelled;
+};
+
+#endif // IMPORTPROGRESS_H
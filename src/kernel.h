@@ -27,9 +27,92 @@
 #include <cs/Bigint.h>
 #include <boost/shared_ptr.hpp>
 #include <CGAL/Polyhedron_3.h>
+#include <QMutex>
+
+// Integer type, selected at build time by ARRANGEMENT_BIGINT
+#if defined(ARRANGEMENT_BIGINT_GMPZ)
+#include <CGAL/Gmpz.h>
+#include <sstream>
+typedef CGAL::Gmpz                                      Z;
+#define ARRANGEMENT_BIGINT_NAME                         "GMPZ"
+#elif defined(ARRANGEMENT_BIGINT_CPP_INT)
+#include <CGAL/boost_mp.h>
+typedef boost::multiprecision::cpp_int                  Z;
+#define ARRANGEMENT_BIGINT_NAME                         "CPP_INT"
+#else
+typedef CGAL::Bigint                                    Z;
+#define ARRANGEMENT_BIGINT_NAME                         "LIDIA"
+#endif
+
+// Integer conversions
+inline void stringToZ(const char *text, Z &result)
+{
+#if defined(ARRANGEMENT_BIGINT_GMPZ)
+    std::istringstream stream(text);
+    stream >> result;
+#elif defined(ARRANGEMENT_BIGINT_CPP_INT)
+    result = Z(text);
+#else
+    LiDIA::string_to_bigint(text, result);
+#endif
+}
+
+// built from 9-digit parts, as long may be only 32 bits wide
+inline Z longLongToZ(long long value)
+{
+    const int PART = 1000000000;
+
+    long long rest = value / PART;
+
+    Z high(static_cast<int>(rest / PART));
+    Z middle(static_cast<int>(rest % PART));
+    Z low(static_cast<int>(value % PART));
+
+    return (high * Z(PART) + middle) * Z(PART) + low;
+}
+
+inline Z absolute(const Z &value)
+{
+    return value < Z(0) ? -value : value;
+}
+
+inline Z greatestCommonDivisor(Z left, Z right)
+{
+    while (right != Z(0))
+    {
+        Z remainder = left % right;
+        left = right;
+        right = remainder;
+    }
+
+    return left;
+}
+
+// note: only for values that fit in a long
+inline long zToLong(const Z &value)
+{
+#if defined(ARRANGEMENT_BIGINT_GMPZ)
+    return mpz_get_si(value.mpz());
+#elif defined(ARRANGEMENT_BIGINT_CPP_INT)
+    return value.convert_to<long>();
+#else
+    long result = 0;
+    value.longify(result);
+    return result;
+#endif
+}
+
+// libcs, CGAL and LiDIA are not known to be reentrant, CGAL is built
+// without CGAL_HAS_THREADS and its handles count references without
+// atomics; every libcs construction, mesher or router call which may
+// overlap with another thread holds this lock
+inline QMutex &kernelMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
 
 // Kernel type
-typedef CGAL::Bigint                                    Z;
 typedef CGAL::Filtered_kernel<CGAL::Cartesian<Z> >      Kernel_Z_base;
 typedef CS::Spin_kernel_3<Kernel_Z_base>                Kernel_Z;
 
@@ -0,0 +1,505 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "lodmeshcache.h"
+#include "kernel.h"
+#include <QGLWidget>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <GL/gl.h>
+#include <log4cxx/logger.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.lodmeshcache"));
+
+double boxDistance(const double minimum[3], const double maximum[3], double x, double y, double z)
+{
+    double point[3] = { x, y, z };
+    double sum = 0;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        double delta = std::max(0.0, std::max(minimum[axis] - point[axis], point[axis] - maximum[axis]));
+        sum += delta * delta;
+    }
+
+    return std::sqrt(sum);
+}
+
+bool lessDistance(const std::pair<double, std::pair<size_t, int> > &a,
+                  const std::pair<double, std::pair<size_t, int> > &b)
+{
+    return a.first < b.first;
+}
+} // namespace anonymous
+
+LodMeshCache::MeshInfo::MeshInfo()
+    : bytes(0)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        minimum[axis] = std::numeric_limits<double>::max();
+        maximum[axis] = -std::numeric_limits<double>::max();
+    }
+}
+
+void LodMeshCache::MeshInfo::include(double x, double y, double z)
+{
+    double point[3] = { x, y, z };
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        minimum[axis] = std::min(minimum[axis], point[axis]);
+        maximum[axis] = std::max(maximum[axis], point[axis]);
+    }
+}
+
+double LodMeshCache::MeshInfo::distance(const QVector3D &point) const
+{
+    // empty
+    if (minimum[0] > maximum[0])
+        return std::numeric_limits<double>::max();
+
+    // spins q and -q are the same rotation
+    return std::min(boxDistance(minimum, maximum, point.x(), point.y(), point.z()),
+                    boxDistance(minimum, maximum, -point.x(), -point.y(), -point.z()));
+}
+
+class LodMeshCache::Job
+    : public QRunnable
+{
+public:
+    Job(LodMeshCache *cache, size_t entry, int level, const Mesher *mesher, MeshingBudgetPtr budget)
+        : m_cache(cache),
+          m_mesher(mesher),
+          m_budget(budget)
+    {
+        m_result.entry = entry;
+        m_result.level = level;
+        m_result.active = true;
+        m_result.skipped = false;
+    }
+
+    virtual void run()
+    {
+        // the build budget only covers the coarsest levels
+        if (m_result.level == 0 && m_budget && m_budget->isExhausted())
+        {
+            m_result.skipped = true;
+        }
+        else
+        {
+            try
+            {
+                QMutexLocker locker(&kernelMutex());
+
+                m_result.active = (*m_mesher)(m_result.level, m_result.meshes, m_result.info);
+
+                if (m_result.level == 0 && m_budget)
+                    m_budget->charge(m_result.info.bytes);
+            }
+            catch (const std::exception &exception)
+            {
+                m_result.error = exception.what();
+            }
+            catch (...)
+            {
+                m_result.error = "unknown meshing error";
+            }
+        }
+
+        {
+            QMutexLocker locker(&m_cache->m_resultMutex);
+            m_cache->m_results.push_back(m_result);
+        }
+
+        // one update for all results finished until the next render
+        if (!m_result.skipped && m_cache->m_gl && m_cache->m_updatePending.testAndSetOrdered(0, 1))
+            QMetaObject::invokeMethod(m_cache->m_gl, "updateGL", Qt::QueuedConnection);
+    }
+
+private:
+    LodMeshCache *      m_cache;
+    const Mesher *      m_mesher;
+    MeshingBudgetPtr    m_budget;
+    Result              m_result;
+};
+
+LodMeshCache::LodMeshCache(QGLWidget *gl, size_t budget)
+    : m_gl(gl),
+      m_budget(budget),
+      m_bytes(0),
+      m_frame(0),
+      m_coarsestPending(0),
+      m_reported(true),
+      m_updatePending(0)
+{
+    // all jobs take the kernel lock, more workers would only wait
+    m_pool.setMaxThreadCount(1);
+}
+
+LodMeshCache::~LodMeshCache()
+{
+    // workers report into this object
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+int LodMeshCache::addGroup(const std::string &name, int levels)
+{
+    Group group;
+    group.name = name;
+    group.levels = std::max(1, std::min(levels, static_cast<int>(NUMBER_OF_LEVELS)));
+
+    m_groups.push_back(group);
+    return static_cast<int>(m_groups.size()) - 1;
+}
+
+void LodMeshCache::add(int group, const Mesher &mesher)
+{
+    Entry entry;
+    entry.group = group;
+    entry.mesher = mesher;
+    entry.busy = false;
+    entry.inactive = false;
+    entry.skipped = false;
+
+    for (int level = 0; level < NUMBER_OF_LEVELS; ++level)
+    {
+        entry.ready[level] = false;
+        entry.failed[level] = false;
+        entry.lastDrawn[level] = 0;
+    }
+
+    m_entries.push_back(entry);
+}
+
+size_t LodMeshCache::size() const
+{
+    return m_entries.size();
+}
+
+void LodMeshCache::setBuildBudget(MeshingBudgetPtr budget)
+{
+    m_buildBudget = budget;
+}
+
+void LodMeshCache::meshCoarsest()
+{
+    scheduleCoarsest();
+
+    m_pool.waitForDone();
+
+    // the coarsest level must exist
+    QMutexLocker locker(&m_resultMutex);
+
+    for (std::vector<Result>::const_iterator it = m_results.begin(); it != m_results.end(); ++it)
+    {
+        if (it->level == 0 && !it->error.empty())
+            throw std::runtime_error("Failed to mesh primitive: " + it->error);
+    }
+
+    locker.unlock();
+
+    collectResults();
+    report();
+}
+
+void LodMeshCache::startCoarsest()
+{
+    scheduleCoarsest();
+}
+
+void LodMeshCache::setFocus(const std::vector<QVector3D> &points)
+{
+    m_focus = points;
+}
+
+void LodMeshCache::beginFrame()
+{
+    collectResults();
+    m_updatePending.fetchAndStoreOrdered(0);
+    ++m_frame;
+
+    if (!m_reported && !m_coarsestPending)
+        report();
+}
+
+void LodMeshCache::endFrame()
+{
+    evict();
+}
+
+void LodMeshCache::render(int group, int level)
+{
+    level = std::max(0, std::min(level, m_groups[group].levels - 1));
+
+    std::vector<std::pair<size_t, int> > requests;
+
+    for (size_t entry = 0; entry < m_entries.size(); ++entry)
+    {
+        Entry &current = m_entries[entry];
+
+        if (current.group != group || current.inactive || !current.ready[0])
+            continue;
+
+        // request the wanted level, one job per primitive at a time
+        if (!current.ready[level] && !current.failed[level] && !current.busy)
+            requests.push_back(std::make_pair(entry, level));
+
+        // finest ready level up to the wanted one, otherwise the closest finer one
+        int drawn = -1;
+
+        for (int candidate = level; candidate >= 0 && drawn < 0; --candidate)
+            if (current.ready[candidate])
+                drawn = candidate;
+
+        for (int candidate = level + 1; candidate < NUMBER_OF_LEVELS && drawn < 0; ++candidate)
+            if (current.ready[candidate])
+                drawn = candidate;
+
+        current.lastDrawn[drawn] = m_frame;
+
+        for (MeshList::const_iterator it = current.meshes[drawn].begin(); it != current.meshes[drawn].end(); ++it)
+            (*it)->render();
+    }
+
+    scheduleFiner(requests);
+}
+
+double LodMeshCache::bound(int level)
+{
+    return 0.4 / (1 << level);
+}
+
+int LodMeshCache::levelForView()
+{
+    GLdouble modelview[16];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+
+    GLdouble camera[3] = { -(modelview[0] * modelview[12] + modelview[1] * modelview[13] + modelview[2] * modelview[14]),
+                           -(modelview[4] * modelview[12] + modelview[5] * modelview[13] + modelview[6] * modelview[14]),
+                           -(modelview[8] * modelview[12] + modelview[9] * modelview[13] + modelview[10] * modelview[14]) };
+
+    double distance = std::sqrt(camera[0] * camera[0] + camera[1] * camera[1] + camera[2] * camera[2]);
+
+    if (distance <= 0)
+        return NUMBER_OF_LEVELS - 1;
+
+    // level 2 at the default camera distance of 5, one level per halving
+    int level = static_cast<int>(std::floor(std::log(20.0 / distance) / std::log(2.0) + 0.5));
+
+    return std::max(0, std::min(level, NUMBER_OF_LEVELS - 1));
+}
+
+void LodMeshCache::scheduleCoarsest()
+{
+    // queued in the order of addition, ahead of all finer levels
+    for (size_t entry = 0; entry < m_entries.size(); ++entry)
+    {
+        const Entry &current = m_entries[entry];
+
+        if (current.ready[0] || current.busy || current.inactive || current.skipped)
+            continue;
+
+        ++m_coarsestPending;
+        m_reported = false;
+
+        schedule(entry, 0);
+    }
+}
+
+void LodMeshCache::schedule(size_t entry, int level)
+{
+    m_entries[entry].busy = true;
+    m_pool.start(new Job(this, entry, level, &m_entries[entry].mesher, m_buildBudget), level == 0 ? 1 : 0);
+}
+
+void LodMeshCache::scheduleFiner(std::vector<std::pair<size_t, int> > &requests)
+{
+    if (m_focus.empty())
+    {
+        for (std::vector<std::pair<size_t, int> >::const_iterator it = requests.begin(); it != requests.end(); ++it)
+            schedule(it->first, it->second);
+
+        return;
+    }
+
+    // nearest to the focus first, judged by the coarsest level
+    std::vector<std::pair<double, std::pair<size_t, int> > > ordered;
+    ordered.reserve(requests.size());
+
+    for (std::vector<std::pair<size_t, int> >::const_iterator it = requests.begin(); it != requests.end(); ++it)
+    {
+        double distance = std::numeric_limits<double>::max();
+
+        for (std::vector<QVector3D>::const_iterator point = m_focus.begin(); point != m_focus.end(); ++point)
+            distance = std::min(distance, m_entries[it->first].info[0].distance(*point));
+
+        ordered.push_back(std::make_pair(distance, *it));
+    }
+
+    std::stable_sort(ordered.begin(), ordered.end(), &lessDistance);
+
+    for (size_t index = 0; index < ordered.size(); ++index)
+        schedule(ordered[index].second.first, ordered[index].second.second);
+}
+
+void LodMeshCache::finish(const Result &result)
+{
+    Entry &entry = m_entries[result.entry];
+
+    entry.busy = false;
+
+    if (result.level == 0)
+        --m_coarsestPending;
+
+    // out of the build budget, left out for good
+    if (result.skipped)
+    {
+        entry.skipped = true;
+        return;
+    }
+
+    // failed finer levels are not retried, the coarser ones stay in use
+    if (!result.error.empty())
+    {
+        entry.failed[result.level] = true;
+        return;
+    }
+
+    if (!result.active)
+    {
+        entry.inactive = true;
+        return;
+    }
+
+    entry.meshes[result.level] = result.meshes;
+    entry.info[result.level] = result.info;
+    entry.ready[result.level] = true;
+
+    // the coarsest level is always kept and is not charged
+    if (result.level > 0)
+        m_bytes += result.info.bytes;
+}
+
+void LodMeshCache::collectResults()
+{
+    std::vector<Result> results;
+
+    {
+        QMutexLocker locker(&m_resultMutex);
+        results.swap(m_results);
+    }
+
+    for (std::vector<Result>::const_iterator it = results.begin(); it != results.end(); ++it)
+        finish(*it);
+}
+
+void LodMeshCache::evict()
+{
+    while (m_bytes > m_budget)
+    {
+        // least recently drawn finer level, not drawn in this frame
+        size_t victimEntry = 0;
+        int victimLevel = -1;
+        unsigned long oldest = m_frame;
+
+        for (size_t entry = 0; entry < m_entries.size(); ++entry)
+        {
+            for (int level = 1; level < NUMBER_OF_LEVELS; ++level)
+            {
+                const Entry &current = m_entries[entry];
+
+                if (current.ready[level] && current.info[level].bytes && current.lastDrawn[level] < oldest)
+                {
+                    victimEntry = entry;
+                    victimLevel = level;
+                    oldest = current.lastDrawn[level];
+                }
+            }
+        }
+
+        if (victimLevel < 0)
+            break;
+
+        Entry &victim = m_entries[victimEntry];
+
+        m_bytes -= victim.info[victimLevel].bytes;
+        victim.meshes[victimLevel].clear();
+        victim.info[victimLevel].bytes = 0;
+        victim.ready[victimLevel] = false;
+    }
+}
+
+void LodMeshCache::report()
+{
+    m_reported = true;
+
+    std::ostringstream text;
+    bool stopped = false;
+
+    for (size_t group = 0; group < m_groups.size(); ++group)
+    {
+        size_t total = 0;
+        size_t skipped = 0;
+        size_t failed = 0;
+
+        for (std::deque<Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if (it->group != static_cast<int>(group))
+                continue;
+
+            ++total;
+
+            if (it->skipped)
+                ++skipped;
+            else if (it->failed[0])
+                ++failed;
+        }
+
+        text << (group ? ", " : "") << m_groups[group].name << " " << total - skipped - failed << " of " << total;
+
+        if (skipped)
+            text << " (" << skipped << " left)";
+
+        if (failed)
+            text << " (" << failed << " failed)";
+
+        stopped = stopped || skipped;
+    }
+
+    if (stopped)
+    {
+        LOG4CXX_INFO(g_logger, "Meshing stopped by the " << m_buildBudget->reason()
+                     << " after " << m_buildBudget->elapsed() << " s: " << text.str());
+    }
+    else
+    {
+        LOG4CXX_INFO(g_logger, "Meshing done: " << text.str());
+    }
+}
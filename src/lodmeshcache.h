@@ -0,0 +1,185 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LODMESHCACHE_H
+#define LODMESHCACHE_H
+
+#include "mesh.h"
+#include "meshingbudget.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThreadPool>
+#include <QVector3D>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <deque>
+#include <string>
+#include <vector>
+
+class QGLWidget;
+
+typedef boost::shared_ptr<Mesh> MeshPtr;
+typedef std::vector<MeshPtr> MeshList;
+
+// meshes of many primitives at several levels of detail
+//
+// the coarsest level of every primitive is meshed first, in the order the
+// primitives were added; finer levels are meshed on a background pool when
+// a render asks for them and are dropped again, least recently drawn first,
+// above the memory budget
+//
+// meshers call into libcs, which is not known to be reentrant, so jobs run
+// one at a time under kernelMutex(); only the GL upload stays on the GUI
+// thread
+class LodMeshCache
+    : private boost::noncopyable
+{
+public:
+    // size and bounding box in s12, s23, s31 of a meshed level
+    struct MeshInfo
+    {
+        MeshInfo();
+
+        void            include(double x, double y, double z);
+
+        // distance of the box or its antipodal image to a point
+        double          distance(const QVector3D &point) const;
+
+        size_t          bytes;
+        double          minimum[3];
+        double          maximum[3];
+    };
+
+    // meshes one primitive at a level and describes the result;
+    // returns false if the primitive has nothing to show at any level
+    //
+    // runs on a worker thread under kernelMutex() and must not touch GL;
+    // meshers are not copied once added, so their libcs handles are only
+    // used by the jobs
+    typedef boost::function<bool (int level, MeshList &meshes, MeshInfo &info)> Mesher;
+
+    static const int NUMBER_OF_LEVELS = 4;
+    static const size_t DEFAULT_BUDGET = 256 << 20;     // 256 MiB of finer levels
+
+    LodMeshCache(QGLWidget *gl, size_t budget = DEFAULT_BUDGET);
+    ~LodMeshCache();
+
+    // primitives are added to named groups, which are rendered separately;
+    // a group may use fewer levels of detail
+    int                 addGroup(const std::string &name, int levels = NUMBER_OF_LEVELS);
+    void                add(int group, const Mesher &mesher);
+    size_t              size() const;
+
+    // limits the meshing of the coarsest levels; primitives which are
+    // not started within the budget are left out and reported
+    void                setBuildBudget(MeshingBudgetPtr budget);
+
+    // mesh the coarsest level of all primitives, blocks
+    void                meshCoarsest();
+
+    // same, but returns at once and shows primitives as they are done
+    void                startCoarsest();
+
+    // finer levels of primitives closer to one of the points are meshed first
+    void                setFocus(const std::vector<QVector3D> &points);
+
+    // a frame renders any number of groups between these two; finished
+    // jobs are taken at the beginning and levels not drawn in the frame
+    // are evicted at the end
+    void                beginFrame();
+    void                endFrame();
+
+    // draw every primitive of a group at the finest ready level up to the
+    // given one; missing levels are scheduled and the view is updated when
+    // they are done
+    void                render(int group, int level);
+
+    // meshing bound at a level, halves with every finer level
+    static double       bound(int level);
+
+    // level for the current modelview, finer when the camera is closer
+    static int          levelForView();
+
+private:
+    struct Group
+    {
+        std::string     name;
+        int             levels;
+    };
+
+    struct Entry
+    {
+        int             group;
+        Mesher          mesher;
+        MeshList        meshes[NUMBER_OF_LEVELS];
+        MeshInfo        info[NUMBER_OF_LEVELS];
+        bool            ready[NUMBER_OF_LEVELS];
+        bool            failed[NUMBER_OF_LEVELS];
+        unsigned long   lastDrawn[NUMBER_OF_LEVELS];
+        bool            busy;
+        bool            inactive;
+        bool            skipped;
+    };
+
+    struct Result
+    {
+        size_t          entry;
+        int             level;
+        bool            active;
+        bool            skipped;
+        MeshList        meshes;
+        MeshInfo        info;
+        std::string     error;
+    };
+
+    class Job;
+
+    QGLWidget *         m_gl;
+    size_t              m_budget;
+    size_t              m_bytes;
+    unsigned long       m_frame;
+
+    std::vector<Group>  m_groups;
+    std::deque<Entry>   m_entries;          // stable for the jobs
+
+    // coarsest levels
+    MeshingBudgetPtr    m_buildBudget;
+    size_t              m_coarsestPending;
+    bool                m_reported;
+
+    std::vector<QVector3D> m_focus;
+
+    // finished jobs, shared with the workers
+    QMutex              m_resultMutex;
+    std::vector<Result> m_results;
+    QAtomicInt          m_updatePending;
+
+    QThreadPool         m_pool;
+
+    void                scheduleCoarsest();
+    void                schedule(size_t entry, int level);
+    void                scheduleFiner(std::vector<std::pair<size_t, int> > &requests);
+    void                finish(const Result &result);
+    void                collectResults();
+    void                evict();
+    void                report();
+};
+
+#endif // LODMESHCACHE_H
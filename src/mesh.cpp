@@ -134,6 +134,20 @@ void disableViewClipPlane()
     //disableObliqueClipPlane();
 }
 
+void enableAntipodalMirror()
+{
+    // point reflection, flips the orientation of faces
+    glPushMatrix();
+    glScaled(-1.0, -1.0, -1.0);
+    glFrontFace(GL_CW);
+}
+
+void disableAntipodalMirror()
+{
+    glFrontFace(GL_CCW);
+    glPopMatrix();
+}
+
 void setColorGL(const QColor &color)
 {
     glColor3ub(color.red(), color.green(), color.blue());
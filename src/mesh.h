@@ -46,6 +46,11 @@ private:
 
 void enableViewClipPlane();
 void disableViewClipPlane();
+
+// spins q and -q are the same rotation; geometry of the s0 >= 0 half
+// rendered in between shows the s0 < 0 half
+void enableAntipodalMirror();
+void disableAntipodalMirror();
 void setColorGL(const QColor &color);
 
 #endif // MESH_H
@@ -0,0 +1,469 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "meshcleanup.h"
+#include "exactsceneconverter.h"
+#include <QElapsedTimer>
+#include <log4cxx/logger.h>
+#include <algorithm>
+#include <vector>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.meshcleanup"));
+
+const size_t NO_VERTEX = static_cast<size_t>(-1);
+
+// integer coordinates times 10^exponent
+struct ExactVertex
+{
+    Z   x, y, z;
+    int exponent;
+};
+
+struct ExactVector
+{
+    Z   x, y, z;
+};
+
+ExactVector operator -(const ExactVector &left, const ExactVector &right)
+{
+    ExactVector result = { left.x - right.x, left.y - right.y, left.z - right.z };
+    return result;
+}
+
+ExactVector cross(const ExactVector &left, const ExactVector &right)
+{
+    ExactVector result = { left.y * right.z - left.z * right.y,
+                           left.z * right.x - left.x * right.z,
+                           left.x * right.y - left.y * right.x };
+    return result;
+}
+
+Z dot(const ExactVector &left, const ExactVector &right)
+{
+    return left.x * right.x + left.y * right.y + left.z * right.z;
+}
+
+bool isZero(const ExactVector &vector)
+{
+    return vector.x == Z(0) && vector.y == Z(0) && vector.z == Z(0);
+}
+
+Z powerOfTen(int exponent)
+{
+    Z result(1);
+    Z square(10);
+
+    while (exponent)
+    {
+        if (exponent & 1)
+            result = result * square;
+
+        exponent >>= 1;
+
+        if (exponent)
+            square = square * square;
+    }
+
+    return result;
+}
+
+// exact copies of the vertices, made on first use
+class ExactVertexCache
+{
+public:
+    explicit ExactVertexCache(const DecimalVectorList &vertices)
+        : m_vertices(vertices),
+          m_exact(vertices.size()),
+          m_converted(vertices.size(), false)
+    {
+    }
+
+    // all three scaled to the given exponent, at most the vertex exponent
+    ExactVector vector(size_t index, int exponent)
+    {
+        const ExactVertex &vertex = exact(index);
+
+        Z scale = powerOfTen(vertex.exponent - exponent);
+        ExactVector result = { vertex.x * scale, vertex.y * scale, vertex.z * scale };
+        return result;
+    }
+
+    int exponent(size_t index)
+    {
+        return exact(index).exponent;
+    }
+
+private:
+    const DecimalVectorList &   m_vertices;
+    std::vector<ExactVertex>    m_exact;
+    std::vector<bool>           m_converted;
+
+    const ExactVertex &exact(size_t index)
+    {
+        if (!m_converted[index])
+        {
+            const DecimalVector &vertex = m_vertices[index];
+            ExactVertex &result = m_exact[index];
+
+            int exponentX, exponentY, exponentZ;
+            decimalToZ(vertex.x(), result.x, exponentX);
+            decimalToZ(vertex.y(), result.y, exponentY);
+            decimalToZ(vertex.z(), result.z, exponentZ);
+
+            result.exponent = std::min(exponentX, std::min(exponentY, exponentZ));
+            result.x = result.x * powerOfTen(exponentX - result.exponent);
+            result.y = result.y * powerOfTen(exponentY - result.exponent);
+            result.z = result.z * powerOfTen(exponentZ - result.exponent);
+
+            m_converted[index] = true;
+        }
+
+        return m_exact[index];
+    }
+};
+
+bool isCollinear(ExactVertexCache &cache, size_t a, size_t b, size_t c)
+{
+    int exponent = std::min(cache.exponent(a), std::min(cache.exponent(b), cache.exponent(c)));
+
+    ExactVector vectorA = cache.vector(a, exponent);
+    return isZero(cross(cache.vector(b, exponent) - vectorA, cache.vector(c, exponent) - vectorA));
+}
+
+// point inside the open segment from begin to end
+bool isStrictlyBetween(ExactVertexCache &cache, size_t point, size_t begin, size_t end)
+{
+    int exponent = std::min(cache.exponent(point), std::min(cache.exponent(begin), cache.exponent(end)));
+
+    ExactVector vectorPoint = cache.vector(point, exponent);
+    ExactVector vectorBegin = cache.vector(begin, exponent);
+    ExactVector vectorEnd = cache.vector(end, exponent);
+
+    return isZero(cross(vectorPoint - vectorBegin, vectorEnd - vectorBegin)) &&
+           dot(vectorPoint - vectorBegin, vectorEnd - vectorPoint) > Z(0);
+}
+
+int compareVertices(const DecimalVector &left, const DecimalVector &right)
+{
+    int result = left.x().compare(right.x());
+
+    if (!result)
+        result = left.y().compare(right.y());
+
+    if (!result)
+        result = left.z().compare(right.z());
+
+    return result;
+}
+
+class VertexLess
+{
+public:
+    explicit VertexLess(const DecimalVectorList &vertices)
+        : m_vertices(&vertices)
+    {
+    }
+
+    bool operator ()(size_t left, size_t right) const
+    {
+        return compareVertices((*m_vertices)[left], (*m_vertices)[right]) < 0;
+    }
+
+private:
+    const DecimalVectorList *m_vertices;
+};
+
+struct Triangle
+{
+    size_t  vertex[3];
+};
+
+// vertices in ascending order, equal for duplicates of any orientation
+struct TriangleKey
+{
+    size_t  vertex[3];
+    size_t  triangle;
+
+    bool operator <(const TriangleKey &other) const
+    {
+        if (!hasSameVertices(other))
+            return std::lexicographical_compare(vertex, vertex + 3, other.vertex, other.vertex + 3);
+
+        return triangle < other.triangle;
+    }
+
+    bool hasSameVertices(const TriangleKey &other) const
+    {
+        return std::equal(vertex, vertex + 3, other.vertex);
+    }
+};
+
+struct Edge
+{
+    size_t  from;
+    size_t  to;
+    size_t  triangle;
+
+    bool operator <(const Edge &other) const
+    {
+        return from < other.from || (from == other.from && to < other.to);
+    }
+};
+
+typedef std::vector<Edge> EdgeList;
+
+size_t countEdges(const EdgeList &edges, size_t from, size_t to)
+{
+    Edge key = { from, to, 0 };
+    std::pair<EdgeList::const_iterator, EdgeList::const_iterator> range = std::equal_range(edges.begin(), edges.end(), key);
+    return static_cast<size_t>(range.second - range.first);
+}
+
+void removeTriangles(std::vector<Triangle> &triangles, const std::vector<bool> &removed)
+{
+    size_t kept = 0;
+
+    for (size_t index = 0; index < triangles.size(); ++index)
+        if (!removed[index])
+            triangles[kept++] = triangles[index];
+
+    triangles.resize(kept);
+}
+
+// a triangle and its neighbour over an edge cover a triangle when one end
+// of the edge lies between the opposite vertices; the end is replaced by
+// the opposite vertex of the neighbour, which keeps the orientation
+size_t mergeCoplanarTriangles(std::vector<Triangle> &triangles, ExactVertexCache &cache)
+{
+    size_t merged = 0;
+
+    for (;;)
+    {
+        EdgeList edges;
+        edges.reserve(3 * triangles.size());
+
+        for (size_t index = 0; index < triangles.size(); ++index)
+        {
+            for (size_t i = 0; i < 3; ++i)
+            {
+                Edge edge = { triangles[index].vertex[i], triangles[index].vertex[(i + 1) % 3], index };
+                edges.push_back(edge);
+            }
+        }
+
+        std::sort(edges.begin(), edges.end());
+
+        // triangles are merged at most once per pass, as edges of merged
+        // triangles are out of date until the next one
+        std::vector<bool> removed(triangles.size(), false);
+        std::vector<bool> touched(triangles.size(), false);
+        size_t mergedInPass = 0;
+
+        for (size_t index = 0; index < triangles.size(); ++index)
+        {
+            if (touched[index])
+                continue;
+
+            Triangle &triangle = triangles[index];
+
+            for (size_t i = 0; i < 3; ++i)
+            {
+                size_t from = triangle.vertex[i];
+                size_t to = triangle.vertex[(i + 1) % 3];
+                size_t opposite = triangle.vertex[(i + 2) % 3];
+
+                // only edges shared by two consistently oriented triangles
+                if (countEdges(edges, from, to) != 1 || countEdges(edges, to, from) != 1)
+                    continue;
+
+                Edge key = { to, from, 0 };
+                size_t neighbourIndex = std::lower_bound(edges.begin(), edges.end(), key)->triangle;
+
+                if (touched[neighbourIndex])
+                    continue;
+
+                const Triangle &neighbour = triangles[neighbourIndex];
+                size_t apex = NO_VERTEX;
+
+                for (size_t j = 0; j < 3; ++j)
+                    if (neighbour.vertex[j] != from && neighbour.vertex[j] != to)
+                        apex = neighbour.vertex[j];
+
+                if (apex == NO_VERTEX || apex == opposite)
+                    continue;
+
+                if (isStrictlyBetween(cache, from, opposite, apex))
+                    triangle.vertex[i] = apex;
+                else if (isStrictlyBetween(cache, to, opposite, apex))
+                    triangle.vertex[(i + 1) % 3] = apex;
+                else
+                    continue;
+
+                removed[neighbourIndex] = true;
+                touched[neighbourIndex] = true;
+                touched[index] = true;
+                ++mergedInPass;
+                break;
+            }
+        }
+
+        if (!mergedInPass)
+            break;
+
+        removeTriangles(triangles, removed);
+        merged += mergedInPass;
+    }
+
+    return merged;
+}
+} // namespace anonymous
+
+DecimalTriangleListPtr cleanUpMesh(const DecimalTriangleList &mesh, bool mergeCoplanar, MeshCleanupReport &report)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const DecimalVectorList &vertices = mesh.vertices();
+    const DecimalFaceList &faces = mesh.faces();
+
+    report.verticesBefore = vertices.size();
+    report.trianglesBefore = faces.size();
+    report.degenerateTriangles = 0;
+    report.duplicateTriangles = 0;
+    report.mergedTriangles = 0;
+
+    // every vertex is replaced by the first of the vertices at its position
+    std::vector<size_t> order(vertices.size());
+
+    for (size_t index = 0; index < order.size(); ++index)
+        order[index] = index;
+
+    std::stable_sort(order.begin(), order.end(), VertexLess(vertices));
+
+    std::vector<size_t> welded(vertices.size());
+    size_t representative = 0;
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (!i || compareVertices(vertices[order[i - 1]], vertices[order[i]]))
+            representative = order[i];
+
+        welded[order[i]] = representative;
+    }
+
+    // degenerate triangles, exact vertices are needed only here and
+    // for merging
+    ExactVertexCache cache(vertices);
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(faces.size());
+
+    for (DecimalFaceList::const_iterator it = faces.begin(); it != faces.end(); ++it)
+    {
+        Triangle triangle;
+
+        for (size_t i = 0; i < 3; ++i)
+            triangle.vertex[i] = welded[it->vertex(static_cast<int>(i))];
+
+        if (triangle.vertex[0] == triangle.vertex[1] ||
+            triangle.vertex[1] == triangle.vertex[2] ||
+            triangle.vertex[2] == triangle.vertex[0] ||
+            isCollinear(cache, triangle.vertex[0], triangle.vertex[1], triangle.vertex[2]))
+        {
+            ++report.degenerateTriangles;
+            continue;
+        }
+
+        triangles.push_back(triangle);
+    }
+
+    // duplicates, the first one is kept
+    std::vector<TriangleKey> keys(triangles.size());
+
+    for (size_t index = 0; index < triangles.size(); ++index)
+    {
+        std::copy(triangles[index].vertex, triangles[index].vertex + 3, keys[index].vertex);
+        std::sort(keys[index].vertex, keys[index].vertex + 3);
+        keys[index].triangle = index;
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<bool> removed(triangles.size(), false);
+
+    for (size_t i = 1; i < keys.size(); ++i)
+    {
+        if (keys[i].hasSameVertices(keys[i - 1]))
+        {
+            removed[keys[i].triangle] = true;
+            ++report.duplicateTriangles;
+        }
+    }
+
+    removeTriangles(triangles, removed);
+
+    if (mergeCoplanar)
+        report.mergedTriangles = mergeCoplanarTriangles(triangles, cache);
+
+    // used vertices in order of first use
+    std::vector<size_t> remap(vertices.size(), NO_VERTEX);
+    DecimalVectorList resultVertices;
+    DecimalFaceList resultFaces;
+
+    resultFaces.reserve(triangles.size());
+
+    for (std::vector<Triangle>::const_iterator it = triangles.begin(); it != triangles.end(); ++it)
+    {
+        size_t face[3];
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            size_t &index = remap[it->vertex[i]];
+
+            if (index == NO_VERTEX)
+            {
+                index = resultVertices.size();
+                resultVertices.push_back(vertices[it->vertex[i]]);
+            }
+
+            face[i] = index;
+        }
+
+        resultFaces.push_back(DecimalFace(face[0], face[1], face[2]));
+    }
+
+    report.verticesAfter = resultVertices.size();
+    report.trianglesAfter = resultFaces.size();
+
+    LOG4CXX_INFO(g_logger, "Mesh cleanup: " << report.verticesBefore << " -> " << report.verticesAfter << " vertices, "
+                 << report.trianglesBefore << " -> " << report.trianglesAfter << " triangles ("
+                 << report.degenerateTriangles << " degenerate, "
+                 << report.duplicateTriangles << " duplicate, "
+                 << report.mergedTriangles << " merged) in " << timer.elapsed() << " ms");
+
+    return DecimalTriangleListPtr(new DecimalTriangleList(resultVertices, resultFaces));
+}
+
+DecimalTriangleListPtr cleanUpMesh(const DecimalTriangleList &mesh, bool mergeCoplanar)
+{
+    MeshCleanupReport report;
+    return cleanUpMesh(mesh, mergeCoplanar, report);
+}
@@ -0,0 +1,50 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MESHCLEANUP_H
+#define MESHCLEANUP_H
+
+#include "decimalscene.h"
+
+// primitive counts before and after a cleanup
+struct MeshCleanupReport
+{
+    size_t  verticesBefore;
+    size_t  verticesAfter;
+    size_t  trianglesBefore;
+    size_t  trianglesAfter;
+
+    // removed triangles by reason
+    size_t  degenerateTriangles;
+    size_t  duplicateTriangles;
+    size_t  mergedTriangles;
+};
+
+// welds vertices with equal decimal coordinates, removes unused vertices,
+// zero-area triangles and triangles over the same vertices as an earlier
+// one; optionally merges pairs of coplanar neighbours whose union is a
+// triangle, as left behind by splitting at a vertex on an edge
+//
+// all tests are exact and the covered surface does not change
+DecimalTriangleListPtr cleanUpMesh(const DecimalTriangleList &mesh, bool mergeCoplanar, MeshCleanupReport &report);
+
+// same, the counts are only logged
+DecimalTriangleListPtr cleanUpMesh(const DecimalTriangleList &mesh, bool mergeCoplanar);
+
+#endif // MESHCLEANUP_H
@@ -0,0 +1,935 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "meshimporter.h"
+#include "texttokenizer.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/ref.hpp>
+#include <log4cxx/logger.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.meshimporter"));
+
+// binary STL: header, triangle count, then normal, three vertices and attributes
+const qint64 STL_HEADER_SIZE = 84;
+const qint64 STL_TRIANGLE_SIZE = 50;
+const qint64 STL_VERTICES_OFFSET = 12;
+
+// exact decimals of tiny or huge binary values are too long for the
+// exact kernel to be of use; these are rounded to the shortest text that
+// reads back as the same binary value
+const size_t MAXIMUM_EXACT_DIGITS = 34;
+
+// largest 64-bit mantissa which is still multiplied exactly
+const quint64 MAXIMUM_EXACT_MANTISSA = Q_UINT64_C(999999999999999999);
+
+// lines read between progress updates
+const int PROGRESS_INTERVAL = 65536;
+
+// values converted by one worker at least
+const size_t MINIMUM_CONVERSION_CHUNK = 16384;
+
+// shares of the progress, the rest is building the vertices
+const int READING_PROGRESS = ImportProgress::MAXIMUM * 4 / 10;
+const int SORTING_PROGRESS = ImportProgress::MAXIMUM * 3 / 10;
+const int CONVERTING_PROGRESS = ImportProgress::MAXIMUM * 2 / 10;
+
+// triangles with binary coordinates, three coordinates per vertex and
+// three vertices per triangle
+struct BinaryMesh
+{
+    std::vector<double>     coordinates;
+    std::vector<quint32>    indices;
+    bool                    singlePrecision;
+};
+
+inline bool isCancelled(ImportProgress *progress)
+{
+    return progress && progress->isCancelled();
+}
+
+inline void setProgress(ImportProgress *progress, int value)
+{
+    if (progress)
+        progress->setValue(value);
+}
+
+inline float readFloat(const uchar *data, bool bigEndian)
+{
+    quint32 bits = bigEndian ? qFromBigEndian<quint32>(data) : qFromLittleEndian<quint32>(data);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline double readDouble(const uchar *data, bool bigEndian)
+{
+    quint64 bits = bigEndian ? qFromBigEndian<quint64>(data) : qFromLittleEndian<quint64>(data);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// writes the digits of value * factor^power, factor is 2 or 5; fails if
+// there are more than MAXIMUM_EXACT_DIGITS
+bool multipliedDigits(quint64 value, int factor, int power, char *digits)
+{
+    // little endian limbs of 9 digits
+    const quint64 LIMB = 1000000000;
+    const size_t MAXIMUM_LIMBS = MAXIMUM_EXACT_DIGITS / 9 + 2;
+
+    quint64 limbs[MAXIMUM_LIMBS];
+    size_t numberOfLimbs = 0;
+
+    for (; value; value /= LIMB)
+        limbs[numberOfLimbs++] = value % LIMB;
+
+    // powers of 2 and 5 below 2^32, so limb products fit
+    int step = factor == 2 ? 31 : 13;
+    quint64 stepFactor = factor == 2 ? (Q_UINT64_C(1) << 31) : Q_UINT64_C(1220703125);
+
+    for (; power > 0; power -= step)
+    {
+        quint64 multiplier = stepFactor;
+
+        if (power < step)
+        {
+            multiplier = 1;
+
+            for (int i = 0; i < power; ++i)
+                multiplier *= static_cast<quint64>(factor);
+        }
+
+        quint64 carry = 0;
+
+        for (size_t i = 0; i < numberOfLimbs; ++i)
+        {
+            quint64 product = limbs[i] * multiplier + carry;
+            limbs[i] = product % LIMB;
+            carry = product / LIMB;
+        }
+
+        for (; carry; carry /= LIMB)
+        {
+            if (numberOfLimbs == MAXIMUM_LIMBS)
+                return false;
+
+            limbs[numberOfLimbs++] = carry % LIMB;
+        }
+    }
+
+    // most significant limb without leading zeros
+    char *current = digits + std::sprintf(digits, "%u", static_cast<unsigned>(limbs[numberOfLimbs - 1]));
+
+    for (size_t i = numberOfLimbs - 1; i > 0; --i)
+    {
+        quint64 limb = limbs[i - 1];
+
+        for (int digit = 8; digit >= 0; --digit, limb /= 10)
+            current[digit] = static_cast<char>('0' + limb % 10);
+
+        current += 9;
+    }
+
+    *current = '\0';
+    return static_cast<size_t>(current - digits) <= MAXIMUM_EXACT_DIGITS;
+}
+
+// decimal with the exact value of a finite binary number
+QDecimal exactDecimal(double value, bool singlePrecision)
+{
+    if (value == 0.0)
+        return QDecimal(0);
+
+    // |value| = mantissa * 2^exponent with an odd mantissa
+    int exponent;
+    double fraction = std::frexp(std::fabs(value), &exponent);
+
+    quint64 mantissa = static_cast<quint64>(std::ldexp(fraction, 53));
+    exponent -= 53;
+
+    while (!(mantissa & 1))
+    {
+        mantissa >>= 1;
+        ++exponent;
+    }
+
+    // 2^exponent is 5^-exponent * 10^exponent
+    int factor = exponent >= 0 ? 2 : 5;
+    int power = std::abs(exponent);
+    int decimalExponent = std::min(exponent, 0);
+
+    // most coordinates of small meshes fit in 64 bits
+    quint64 scaled = mantissa;
+    int scaledPower = 0;
+
+    while (scaledPower < power && scaled <= MAXIMUM_EXACT_MANTISSA / static_cast<quint64>(factor))
+    {
+        scaled *= static_cast<quint64>(factor);
+        ++scaledPower;
+    }
+
+    if (scaledPower == power)
+        return QDecimal(value < 0.0 ? -static_cast<qint64>(scaled) : static_cast<qint64>(scaled), decimalExponent);
+
+    // sign, digits, exponent
+    char buffer[MAXIMUM_EXACT_DIGITS + 32];
+
+    if (multipliedDigits(mantissa, factor, power, buffer + 1))
+    {
+        buffer[0] = value < 0.0 ? '-' : '+';
+        std::sprintf(buffer + std::strlen(buffer), "E%d", decimalExponent);
+    }
+    else
+    {
+        std::sprintf(buffer, singlePrecision ? "%.9g" : "%.17g", value);
+    }
+
+    return QDecimal().fromString(buffer);
+}
+
+bool readStl(const uchar *data, qint64 size, BinaryMesh &mesh)
+{
+    if (size < STL_HEADER_SIZE)
+        return false;
+
+    // text STL files fail here as well
+    qint64 numberOfTriangles = qFromLittleEndian<quint32>(data + STL_HEADER_SIZE - 4);
+
+    if (size < STL_HEADER_SIZE + numberOfTriangles * STL_TRIANGLE_SIZE)
+        return false;
+
+    size_t numberOfCorners = 3 * static_cast<size_t>(numberOfTriangles);
+
+    mesh.singlePrecision = true;
+    mesh.coordinates.resize(3 * numberOfCorners);
+    mesh.indices.resize(numberOfCorners);
+
+    for (size_t triangle = 0; triangle < static_cast<size_t>(numberOfTriangles); ++triangle)
+    {
+        const uchar *record = data + STL_HEADER_SIZE + static_cast<qint64>(triangle) * STL_TRIANGLE_SIZE + STL_VERTICES_OFFSET;
+
+        for (size_t i = 0; i < 9; ++i)
+            mesh.coordinates[9 * triangle + i] = readFloat(record + 4 * i, false);
+    }
+
+    for (size_t i = 0; i < numberOfCorners; ++i)
+        mesh.indices[i] = static_cast<quint32>(i);
+
+    return true;
+}
+
+enum PlyType
+{
+    PlyType_Int8,
+    PlyType_UInt8,
+    PlyType_Int16,
+    PlyType_UInt16,
+    PlyType_Int32,
+    PlyType_UInt32,
+    PlyType_Float32,
+    PlyType_Float64,
+    PlyType_Invalid
+};
+
+struct PlyProperty
+{
+    std::string     name;
+    PlyType         type;
+    bool            list;
+    PlyType         countType;
+};
+
+struct PlyElement
+{
+    std::string                 name;
+    size_t                      count;
+    std::vector<PlyProperty>    properties;
+};
+
+PlyType plyType(const std::string &name)
+{
+    if (name == "char" || name == "int8") return PlyType_Int8;
+    if (name == "uchar" || name == "uint8") return PlyType_UInt8;
+    if (name == "short" || name == "int16") return PlyType_Int16;
+    if (name == "ushort" || name == "uint16") return PlyType_UInt16;
+    if (name == "int" || name == "int32") return PlyType_Int32;
+    if (name == "uint" || name == "uint32") return PlyType_UInt32;
+    if (name == "float" || name == "float32") return PlyType_Float32;
+    if (name == "double" || name == "float64") return PlyType_Float64;
+
+    return PlyType_Invalid;
+}
+
+size_t plyTypeSize(PlyType type)
+{
+    switch (type)
+    {
+    case PlyType_Int8:
+    case PlyType_UInt8:
+        return 1;
+
+    case PlyType_Int16:
+    case PlyType_UInt16:
+        return 2;
+
+    case PlyType_Int32:
+    case PlyType_UInt32:
+    case PlyType_Float32:
+        return 4;
+
+    case PlyType_Float64:
+        return 8;
+
+    default:
+        return 0;
+    }
+}
+
+// reads one value and moves past it, fails at the end of data
+bool readPlyValue(const uchar *&current, const uchar *end, PlyType type, bool bigEndian, double &value)
+{
+    size_t size = plyTypeSize(type);
+
+    if (static_cast<size_t>(end - current) < size)
+        return false;
+
+    switch (type)
+    {
+    case PlyType_Int8:    value = static_cast<qint8>(*current); break;
+    case PlyType_UInt8:   value = *current; break;
+    case PlyType_Int16:   value = bigEndian ? qFromBigEndian<qint16>(current) : qFromLittleEndian<qint16>(current); break;
+    case PlyType_UInt16:  value = bigEndian ? qFromBigEndian<quint16>(current) : qFromLittleEndian<quint16>(current); break;
+    case PlyType_Int32:   value = bigEndian ? qFromBigEndian<qint32>(current) : qFromLittleEndian<qint32>(current); break;
+    case PlyType_UInt32:  value = bigEndian ? qFromBigEndian<quint32>(current) : qFromLittleEndian<quint32>(current); break;
+    case PlyType_Float32: value = readFloat(current, bigEndian); break;
+    case PlyType_Float64: value = readDouble(current, bigEndian); break;
+    default: return false;
+    }
+
+    current += size;
+    return true;
+}
+
+bool readPlyHeader(const char *&current, const char *end, std::vector<PlyElement> &elements, bool &bigEndian)
+{
+    bool magic = false;
+    bool format = false;
+
+    while (current != end)
+    {
+        const char *lineEnd = std::find(current, end, '\n');
+        std::string line(current, lineEnd);
+
+        current = (lineEnd == end) ? end : lineEnd + 1;
+
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.resize(line.size() - 1);
+
+        std::vector<std::string> words;
+        std::string::size_type position = 0;
+
+        while ((position = line.find_first_not_of(" \t", position)) != std::string::npos)
+        {
+            std::string::size_type wordEnd = line.find_first_of(" \t", position);
+            words.push_back(line.substr(position, wordEnd - position));
+            position = wordEnd;
+        }
+
+        if (!magic)
+        {
+            if (words.size() != 1 || words[0] != "ply")
+                return false;
+
+            magic = true;
+        }
+        else if (words.empty() || words[0] == "comment" || words[0] == "obj_info")
+        {
+            continue;
+        }
+        else if (words[0] == "format")
+        {
+            // text PLY files are not supported
+            if (words.size() < 2 || (words[1] != "binary_little_endian" && words[1] != "binary_big_endian"))
+                return false;
+
+            bigEndian = words[1] == "binary_big_endian";
+            format = true;
+        }
+        else if (words[0] == "element" && words.size() == 3)
+        {
+            PlyElement element;
+            element.name = words[1];
+
+            if (!parseSize(words[2].data(), words[2].data() + words[2].size(), element.count))
+                return false;
+
+            elements.push_back(element);
+        }
+        else if (words[0] == "property" && !elements.empty())
+        {
+            PlyProperty property;
+
+            if (words.size() == 5 && words[1] == "list")
+            {
+                property.list = true;
+                property.countType = plyType(words[2]);
+                property.type = plyType(words[3]);
+                property.name = words[4];
+            }
+            else if (words.size() == 3)
+            {
+                property.list = false;
+                property.countType = PlyType_Invalid;
+                property.type = plyType(words[1]);
+                property.name = words[2];
+            }
+            else
+            {
+                return false;
+            }
+
+            if (property.type == PlyType_Invalid || (property.list && property.countType == PlyType_Invalid))
+                return false;
+
+            elements.back().properties.push_back(property);
+        }
+        else if (words[0] == "end_header")
+        {
+            return format;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool readPly(const uchar *data, qint64 size, BinaryMesh &mesh, ImportProgress *progress)
+{
+    const char *text = reinterpret_cast<const char *>(data);
+    const char *textEnd = text + size;
+
+    std::vector<PlyElement> elements;
+    bool bigEndian = false;
+
+    if (!readPlyHeader(text, textEnd, elements, bigEndian))
+        return false;
+
+    const uchar *current = reinterpret_cast<const uchar *>(text);
+    const uchar *end = data + size;
+
+    size_t numberOfVertices = 0;
+    bool verticesRead = false;
+
+    mesh.singlePrecision = true;
+
+    for (std::vector<PlyElement>::const_iterator element = elements.begin(); element != elements.end(); ++element)
+    {
+        bool vertices = element->name == "vertex";
+        bool faces = element->name == "face";
+
+        // where x, y, z and the vertex list are among the properties
+        int roles[4] = { -1, -1, -1, -1 };
+
+        for (size_t i = 0; i < element->properties.size(); ++i)
+        {
+            const PlyProperty &property = element->properties[i];
+
+            if (vertices && !property.list && property.name.size() == 1 && property.name[0] >= 'x' && property.name[0] <= 'z')
+                roles[property.name[0] - 'x'] = static_cast<int>(i);
+
+            if (faces && property.list && (property.name == "vertex_indices" || property.name == "vertex_index"))
+                roles[3] = static_cast<int>(i);
+        }
+
+        if (vertices)
+        {
+            if (roles[0] < 0 || roles[1] < 0 || roles[2] < 0)
+                return false;
+
+            for (int i = 0; i < 3; ++i)
+                if (element->properties[static_cast<size_t>(roles[i])].type != PlyType_Float32)
+                    mesh.singlePrecision = false;
+
+            numberOfVertices = element->count;
+            mesh.coordinates.reserve(3 * numberOfVertices);
+            verticesRead = true;
+        }
+
+        if (faces && (roles[3] < 0 || !verticesRead))
+            return false;
+
+        std::vector<quint32> polygon;
+
+        for (size_t record = 0; record < element->count; ++record)
+        {
+            if (!(record % PROGRESS_INTERVAL))
+            {
+                if (isCancelled(progress))
+                    return false;
+
+                setProgress(progress, static_cast<int>(READING_PROGRESS * (current - data) / size));
+            }
+
+            double coordinates[3] = { 0.0, 0.0, 0.0 };
+
+            for (size_t i = 0; i < element->properties.size(); ++i)
+            {
+                const PlyProperty &property = element->properties[i];
+                double value;
+
+                if (!property.list)
+                {
+                    if (!readPlyValue(current, end, property.type, bigEndian, value))
+                        return false;
+
+                    for (int axis = 0; axis < 3; ++axis)
+                        if (roles[axis] == static_cast<int>(i))
+                            coordinates[axis] = value;
+
+                    continue;
+                }
+
+                double count;
+
+                if (!readPlyValue(current, end, property.countType, bigEndian, count) || count < 0.0)
+                    return false;
+
+                polygon.clear();
+
+                for (size_t item = 0; item < static_cast<size_t>(count); ++item)
+                {
+                    if (!readPlyValue(current, end, property.type, bigEndian, value))
+                        return false;
+
+                    if (roles[3] == static_cast<int>(i))
+                    {
+                        if (value < 0.0 || value >= static_cast<double>(numberOfVertices))
+                            return false;
+
+                        polygon.push_back(static_cast<quint32>(value));
+                    }
+                }
+
+                // polygons are split into a fan
+                for (size_t corner = 2; corner < polygon.size(); ++corner)
+                {
+                    mesh.indices.push_back(polygon[0]);
+                    mesh.indices.push_back(polygon[corner - 1]);
+                    mesh.indices.push_back(polygon[corner]);
+                }
+            }
+
+            if (vertices)
+                mesh.coordinates.insert(mesh.coordinates.end(), coordinates, coordinates + 3);
+        }
+    }
+
+    return verticesRead;
+}
+
+struct WeldKey
+{
+    quint64     bits[3];
+    quint32     vertex;
+
+    bool operator <(const WeldKey &other) const
+    {
+        return std::lexicographical_compare(bits, bits + 3, other.bits, other.bits + 3);
+    }
+
+    bool hasSamePosition(const WeldKey &other) const
+    {
+        return std::equal(bits, bits + 3, other.bits);
+    }
+};
+
+class RangeJob
+    : public QRunnable
+{
+public:
+    RangeJob(const boost::function<void (size_t, size_t)> &task, size_t begin, size_t end)
+        : m_task(task),
+          m_begin(begin),
+          m_end(end)
+    {
+    }
+
+    virtual void run()
+    {
+        m_task(m_begin, m_end);
+    }
+
+private:
+    boost::function<void (size_t, size_t)>  m_task;
+    size_t                                  m_begin;
+    size_t                                  m_end;
+};
+
+// splits [0, size) among the cores
+void runRanges(size_t size, const boost::function<void (size_t, size_t)> &task)
+{
+    size_t numberOfRanges = std::max(size_t(1), std::min(static_cast<size_t>(QThread::idealThreadCount()), size / MINIMUM_CONVERSION_CHUNK));
+
+    if (numberOfRanges == 1)
+    {
+        task(0, size);
+        return;
+    }
+
+    QThreadPool pool;
+
+    for (size_t range = 0; range < numberOfRanges; ++range)
+        pool.start(new RangeJob(task, size * range / numberOfRanges, size * (range + 1) / numberOfRanges));
+
+    pool.waitForDone();
+}
+
+void convertValues(const std::vector<double> &values, bool singlePrecision, std::vector<QDecimal> &decimals, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i)
+        decimals[i] = exactDecimal(values[i], singlePrecision);
+}
+
+void buildVertices(const BinaryMesh &mesh, const std::vector<quint32> &originals,
+                   const std::vector<double> &values, const std::vector<QDecimal> &decimals,
+                   DecimalVectorList &vertices, size_t begin, size_t end)
+{
+    for (size_t index = begin; index < end; ++index)
+    {
+        const double *coordinates = &mesh.coordinates[3 * originals[index]];
+        size_t found[3];
+
+        for (size_t axis = 0; axis < 3; ++axis)
+            found[axis] = static_cast<size_t>(std::lower_bound(values.begin(), values.end(), coordinates[axis] + 0.0) - values.begin());
+
+        vertices[index] = DecimalVector(decimals[found[0]], decimals[found[1]], decimals[found[2]]);
+    }
+}
+
+// merges vertices with equal coordinates and converts the rest to
+// decimals, in the order they are first used
+bool weld(const BinaryMesh &mesh, DecimalVectorList &vertices, DecimalFaceList &faces, ImportProgress *progress)
+{
+    size_t numberOfVertices = mesh.coordinates.size() / 3;
+
+    std::vector<WeldKey> keys(numberOfVertices);
+
+    for (size_t vertex = 0; vertex < numberOfVertices; ++vertex)
+    {
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            // -0 and 0 are the same coordinate
+            double value = mesh.coordinates[3 * vertex + axis] + 0.0;
+
+            if (!std::isfinite(value))
+                return false;
+
+            std::memcpy(&keys[vertex].bits[axis], &value, sizeof(value));
+        }
+
+        keys[vertex].vertex = static_cast<quint32>(vertex);
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    if (isCancelled(progress))
+        return false;
+
+    setProgress(progress, READING_PROGRESS + SORTING_PROGRESS);
+
+    // group of every vertex
+    std::vector<quint32> groups(numberOfVertices);
+    quint32 numberOfGroups = 0;
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (i && !keys[i].hasSamePosition(keys[i - 1]))
+            ++numberOfGroups;
+
+        groups[keys[i].vertex] = numberOfGroups;
+    }
+
+    // number groups by first use
+    const quint32 UNUSED = 0xffffffffu;
+    std::vector<quint32> remap(keys.empty() ? 0 : numberOfGroups + 1, UNUSED);
+    std::vector<quint32> originals;
+
+    faces.clear();
+    faces.reserve(mesh.indices.size() / 3);
+
+    for (size_t corner = 0; corner + 2 < mesh.indices.size(); corner += 3)
+    {
+        size_t face[3];
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            quint32 vertex = mesh.indices[corner + i];
+            quint32 &index = remap[groups[vertex]];
+
+            if (index == UNUSED)
+            {
+                index = static_cast<quint32>(originals.size());
+                originals.push_back(vertex);
+            }
+
+            face[i] = index;
+        }
+
+        faces.push_back(DecimalFace(face[0], face[1], face[2]));
+    }
+
+    if (isCancelled(progress))
+        return false;
+
+    // most float coordinates have exact decimals too long for the fast
+    // path of QDecimal; these are slow to make and large, so every
+    // distinct value is converted once and shared by its vertices
+    std::vector<double> values;
+    values.reserve(3 * originals.size());
+
+    for (std::vector<quint32>::const_iterator it = originals.begin(); it != originals.end(); ++it)
+        for (size_t axis = 0; axis < 3; ++axis)
+            values.push_back(mesh.coordinates[3 * *it + axis] + 0.0);
+
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    if (isCancelled(progress))
+        return false;
+
+    std::vector<QDecimal> decimals(values.size());
+    runRanges(values.size(), boost::bind(&convertValues, boost::cref(values), mesh.singlePrecision, boost::ref(decimals), _1, _2));
+
+    if (isCancelled(progress))
+        return false;
+
+    setProgress(progress, READING_PROGRESS + SORTING_PROGRESS + CONVERTING_PROGRESS);
+
+    vertices.assign(originals.size(), DecimalVector());
+    runRanges(originals.size(), boost::bind(&buildVertices, boost::cref(mesh), boost::cref(originals), boost::cref(values), boost::cref(decimals), boost::ref(vertices), _1, _2));
+
+    LOG4CXX_INFO(g_logger, "Mesh import: " << values.size() << " distinct coordinates");
+    return true;
+}
+
+// vertex of a face corner, v, v/vt, v//vn or v/vt/vn; negative indices
+// count back from the last vertex
+bool parseCorner(const char *begin, const char *end, size_t numberOfVertices, size_t &vertex)
+{
+    bool negative = false;
+
+    if (begin != end && *begin == '-')
+    {
+        negative = true;
+        ++begin;
+    }
+
+    size_t value;
+
+    if (!parseSize(begin, std::find(begin, end, '/'), value) || !value || value > numberOfVertices)
+        return false;
+
+    vertex = negative ? numberOfVertices - value : value - 1;
+    return true;
+}
+
+bool readObj(const char *data, qint64 size, DecimalVectorList &vertices, DecimalFaceList &faces, ImportProgress *progress)
+{
+    const char *current = data;
+    const char *end = data + size;
+
+    std::vector<size_t> polygon;
+    size_t line = 0;
+
+    vertices.clear();
+    faces.clear();
+
+    while (current != end)
+    {
+        const char *lineEnd = std::find(current, end, '\n');
+        const char *tokenBegin, *tokenEnd;
+
+        if (!(line++ % PROGRESS_INTERVAL))
+        {
+            if (isCancelled(progress))
+                return false;
+
+            setProgress(progress, static_cast<int>(ImportProgress::MAXIMUM * (current - data) / size));
+        }
+
+        if (nextToken(current, lineEnd, tokenBegin, tokenEnd))
+        {
+            size_t length = static_cast<size_t>(tokenEnd - tokenBegin);
+
+            if (length == 1 && *tokenBegin == 'v')
+            {
+                QDecimal coordinates[3];
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    if (!nextToken(current, lineEnd, tokenBegin, tokenEnd))
+                        return false;
+
+                    parseDecimal(tokenBegin, tokenEnd, coordinates[axis]);
+                }
+
+                vertices.push_back(DecimalVector(coordinates[0], coordinates[1], coordinates[2]));
+            }
+            else if (length == 1 && *tokenBegin == 'f')
+            {
+                polygon.clear();
+
+                while (nextToken(current, lineEnd, tokenBegin, tokenEnd))
+                {
+                    size_t vertex;
+
+                    if (!parseCorner(tokenBegin, tokenEnd, vertices.size(), vertex))
+                        return false;
+
+                    polygon.push_back(vertex);
+                }
+
+                // polygons are split into a fan
+                for (size_t corner = 2; corner < polygon.size(); ++corner)
+                    faces.push_back(DecimalFace(polygon[0], polygon[corner - 1], polygon[corner]));
+            }
+
+            // normals, texture coordinates, groups and materials are skipped
+        }
+
+        current = (lineEnd == end) ? end : lineEnd + 1;
+    }
+
+    return true;
+}
+} // namespace anonymous
+
+MeshImporter::MeshImporter()
+{
+}
+
+MeshImporter::Format MeshImporter::format(const char *fileName)
+{
+    QString suffix = QFileInfo(QString::fromLocal8Bit(fileName)).suffix().toLower();
+
+    if (suffix == "stl")
+        return Format_Stl;
+
+    if (suffix == "ply")
+        return Format_Ply;
+
+    if (suffix == "obj")
+        return Format_Obj;
+
+    return Format_Unknown;
+}
+
+MeshImporterPtr MeshImporter::load(const char *fileName, ImportProgress *progress)
+{
+    Format fileFormat = format(fileName);
+
+    if (fileFormat == Format_Unknown)
+        return MeshImporterPtr();
+
+    QFile file(QString::fromLocal8Bit(fileName));
+
+    if (!file.open(QFile::ReadOnly) || !file.size())
+        return MeshImporterPtr();
+
+    // the mapping lives as long as the file object
+    const uchar *data = file.map(0, file.size());
+
+    if (!data)
+        return MeshImporterPtr();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    MeshImporterPtr importer(new MeshImporter());
+    bool succeeded;
+
+    if (fileFormat == Format_Obj)
+    {
+        succeeded = readObj(reinterpret_cast<const char *>(data), file.size(), importer->m_vertices, importer->m_faces, progress);
+    }
+    else
+    {
+        BinaryMesh mesh;
+
+        if (fileFormat == Format_Stl)
+            succeeded = readStl(data, file.size(), mesh);
+        else
+            succeeded = readPly(data, file.size(), mesh, progress);
+
+        if (succeeded && isCancelled(progress))
+            succeeded = false;
+
+        if (succeeded)
+        {
+            setProgress(progress, READING_PROGRESS);
+            succeeded = weld(mesh, importer->m_vertices, importer->m_faces, progress);
+        }
+
+        if (succeeded)
+            LOG4CXX_INFO(g_logger, "Mesh import: " << mesh.coordinates.size() / 3 << " vertices welded to " << importer->m_vertices.size());
+    }
+
+    if (!succeeded)
+    {
+        if (!isCancelled(progress))
+            LOG4CXX_WARN(g_logger, "Mesh import: failed to read " << fileName);
+
+        return MeshImporterPtr();
+    }
+
+    LOG4CXX_INFO(g_logger, "Mesh import: " << fileName << ", " << importer->m_faces.size() << " triangles in " << timer.elapsed() << " ms");
+
+    setProgress(progress, ImportProgress::MAXIMUM);
+    return importer;
+}
+
+const DecimalVectorList &MeshImporter::vertices() const
+{
+    return m_vertices;
+}
+
+const DecimalFaceList &MeshImporter::faces() const
+{
+    return m_faces;
+}
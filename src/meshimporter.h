@@ -0,0 +1,62 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MESHIMPORTER_H
+#define MESHIMPORTER_H
+
+#include "decimalscene.h"
+#include "importprogress.h"
+#include <boost/shared_ptr.hpp>
+
+class MeshImporter;
+typedef boost::shared_ptr<MeshImporter> MeshImporterPtr;
+
+// triangle meshes exported by CAD tools: binary STL, binary PLY and OBJ
+//
+// binary coordinates are converted to the decimals of their exact values
+// and equal vertices are welded, so triangle soups become indexed meshes;
+// OBJ coordinates are parsed as written and keep their own indexing
+class MeshImporter
+{
+public:
+    enum Format
+    {
+        Format_Unknown,
+        Format_Stl,
+        Format_Ply,
+        Format_Obj
+    };
+
+    // by file name extension
+    static Format               format(const char *fileName);
+
+    // progress is optional; returns null on errors and when cancelled
+    static MeshImporterPtr      load(const char *fileName, ImportProgress *progress = 0);
+
+    const DecimalVectorList &   vertices() const;
+    const DecimalFaceList &     faces() const;
+
+private:
+    DecimalVectorList           m_vertices;
+    DecimalFaceList             m_faces;
+
+    MeshImporter();
+};
+
+#endif // MESHIMPORTER_H
@@ -0,0 +1,62 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "meshingbudget.h"
+#include <QMutexLocker>
+
+MeshingBudget::MeshingBudget(double seconds, size_t bytes)
+    : m_seconds(seconds),
+      m_bytes(bytes),
+      m_charged(0)
+{
+    m_timer.start();
+}
+
+void MeshingBudget::charge(size_t bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_charged += bytes;
+}
+
+bool MeshingBudget::isExhausted() const
+{
+    return !reason().empty();
+}
+
+std::string MeshingBudget::reason() const
+{
+    if (m_seconds > 0 && elapsed() >= m_seconds)
+        return "time budget";
+
+    if (m_bytes > 0 && charged() >= m_bytes)
+        return "memory budget";
+
+    return std::string();
+}
+
+double MeshingBudget::elapsed() const
+{
+    return m_timer.elapsed() / 1000.0;
+}
+
+size_t MeshingBudget::charged() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_charged;
+}
@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MESHINGBUDGET_H
+#define MESHINGBUDGET_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+// time and memory limits of one exact build, zero means no limit
+//
+// the clock starts at construction; meshing jobs charge the memory of
+// their results and check the budget before they start
+class MeshingBudget
+    : private boost::noncopyable
+{
+public:
+    MeshingBudget(double seconds, size_t bytes);
+
+    void            charge(size_t bytes);
+
+    bool            isExhausted() const;
+
+    // limit which was hit, empty if none
+    std::string     reason() const;
+
+    double          elapsed() const;
+    size_t          charged() const;
+
+private:
+    double          m_seconds;
+    size_t          m_bytes;
+    size_t          m_charged;
+    QElapsedTimer   m_timer;
+    mutable QMutex  m_mutex;
+};
+
+typedef boost::shared_ptr<MeshingBudget> MeshingBudgetPtr;
+
+#endif // MESHINGBUDGET_H
@@ -0,0 +1,286 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "neighbourcollectprofile.h"
+#include "importprogress.h"
+#include "kernel.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSettings>
+#include <log4cxx/logger.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.neighbourcollectprofile"));
+
+// representative sample counts, from quick to a large cell graph; the
+// steps are small enough that a quadratic algorithm grows at most tenfold
+const size_t CALIBRATION_SAMPLE_COUNTS[] = { 1000, 3000, 10000, 30000, 100000, 300000, 1000000 };
+const size_t NUMBER_OF_CALIBRATION_SAMPLE_COUNTS = sizeof(CALIBRATION_SAMPLE_COUNTS) / sizeof(CALIBRATION_SAMPLE_COUNTS[0]);
+
+const double MINIMUM_COST = 1e-6;
+
+// the naive collect is quadratic in the sample count
+const double WORST_EXPONENT = 2.0;
+
+// fixed overhead flattens small counts, so beyond the measured range the
+// cost never grows slower than linearly
+double growthExponent(size_t fromCount, double fromCost, size_t toCount, double toCost, bool extrapolated)
+{
+    double exponent = std::log(toCost / fromCost) / std::log(double(toCount) / double(fromCount));
+    return extrapolated ? std::max(1.0, exponent) : exponent;
+}
+
+double costAt(size_t fromCount, double fromCost, size_t toCount, double toCost, size_t sampleCount)
+{
+    // power law through two measurements
+    bool extrapolated = sampleCount > toCount;
+    double exponent = growthExponent(fromCount, fromCost, toCount, toCost, extrapolated);
+    return fromCost * std::pow(double(sampleCount) / double(fromCount), exponent);
+}
+
+double predictedCost(const std::map<size_t, double> &costs, size_t sampleCount)
+{
+    assert(!costs.empty());
+
+    std::map<size_t, double>::const_reverse_iterator last = costs.rbegin();
+
+    // a single measurement cannot tell the growth, assume the worst one
+    double exponent = WORST_EXPONENT;
+
+    if (costs.size() > 1)
+    {
+        std::map<size_t, double>::const_reverse_iterator previous = last;
+        ++previous;
+
+        exponent = growthExponent(previous->first, previous->second, last->first, last->second, true);
+    }
+
+    return last->second * std::pow(double(sampleCount) / double(last->first), exponent);
+}
+} // namespace anonymous
+
+const double NeighbourCollectProfile::DEFAULT_TIME_LIMIT = 10.0;
+
+NeighbourCollectProfile::NeighbourCollectProfile()
+{
+}
+
+bool NeighbourCollectProfile::isEmpty() const
+{
+    for (int index = 0; index < NUMBER_OF_ALGORITHMS; ++index)
+        if (!m_costs[index].empty())
+            return false;
+
+    return true;
+}
+
+void NeighbourCollectProfile::setCost(int algorithm, size_t sampleCount, double seconds)
+{
+    assert(algorithm >= 1 && algorithm <= NUMBER_OF_ALGORITHMS);
+    m_costs[algorithm - 1][sampleCount] = std::max(seconds, MINIMUM_COST);
+}
+
+double NeighbourCollectProfile::expectedCost(int algorithm, size_t sampleCount) const
+{
+    assert(algorithm >= 1 && algorithm <= NUMBER_OF_ALGORITHMS);
+
+    const Costs &costs = m_costs[algorithm - 1];
+
+    if (costs.empty())
+        return -1;
+
+    // a single measurement scales linearly
+    if (costs.size() == 1)
+        return costs.begin()->second * double(sampleCount) / double(costs.begin()->first);
+
+    // two measured counts around the wanted one, or the two closest ones
+    Costs::const_iterator upper = costs.lower_bound(sampleCount);
+
+    if (upper != costs.end() && upper->first == sampleCount)
+        return upper->second;
+
+    if (upper == costs.begin())
+        ++upper;
+    else if (upper == costs.end())
+        --upper;
+
+    Costs::const_iterator lower = upper;
+    --lower;
+
+    return costAt(lower->first, lower->second, upper->first, upper->second, sampleCount);
+}
+
+int NeighbourCollectProfile::fastest(size_t sampleCount, double *cost) const
+{
+    int best = 0;
+    double bestCost = 0;
+    bool bestMeasured = false;
+
+    for (int algorithm = 1; algorithm <= NUMBER_OF_ALGORITHMS; ++algorithm)
+    {
+        double current = expectedCost(algorithm, sampleCount);
+
+        if (current < 0)
+            continue;
+
+        // algorithms measured at or above the count are preferred over
+        // extrapolated ones, which stopped early in the calibration;
+        // on a tie the asymptotically better one
+        bool measured = m_costs[algorithm - 1].rbegin()->first >= sampleCount;
+
+        if (!best || (measured && !bestMeasured) || (measured == bestMeasured && current <= bestCost))
+        {
+            best = algorithm;
+            bestCost = current;
+            bestMeasured = measured;
+        }
+    }
+
+    if (cost)
+        *cost = bestCost;
+
+    return best;
+}
+
+bool NeighbourCollectProfile::calibrate(ImportProgress *progress, double timeLimit)
+{
+    // two balls which touch for some rotations, so that both empty
+    // and full cells are collected
+    Ball_list_3_R robot;
+    robot.push_back(Ball_3_R(Vector_3_R(1, 0, 0), 0.5));
+
+    Ball_list_3_R obstacles;
+    obstacles.push_back(Ball_3_R(Vector_3_R(0, 1, 0), 0.75));
+
+    const int steps = NUMBER_OF_ALGORITHMS * int(NUMBER_OF_CALIBRATION_SAMPLE_COUNTS);
+
+    for (int algorithm = 1; algorithm <= NUMBER_OF_ALGORITHMS; ++algorithm)
+    {
+        m_costs[algorithm - 1].clear();
+
+        CS::Config::set_neighbour_collect_algorithm(algorithm);
+
+        for (size_t index = 0; index < NUMBER_OF_CALIBRATION_SAMPLE_COUNTS; ++index)
+        {
+            // a running build cannot be interrupted, stop before the next one
+            if (progress && progress->isCancelled())
+            {
+                LOG4CXX_INFO(g_logger, "Neighbour collect calibration cancelled");
+                return false;
+            }
+
+            size_t sampleCount = CALIBRATION_SAMPLE_COUNTS[index];
+
+            // skip counts which would take longer than the limit
+            if (!m_costs[algorithm - 1].empty() && predictedCost(m_costs[algorithm - 1], sampleCount) > timeLimit)
+                break;
+
+            QMutexLocker locker(&kernelMutex());
+
+            QElapsedTimer timer;
+            timer.start();
+
+            Spin_configuration_space_3::Cell_BB_R configuration;
+            configuration.create_from_scene(robot.begin(), robot.end(),
+                                            obstacles.begin(), obstacles.end(),
+                                            Spin_configuration_space_3::Cell_BB_R::Parameters(sampleCount));
+
+            double seconds = timer.nsecsElapsed() / 1e9;
+            locker.unlock();
+            setCost(algorithm, sampleCount, seconds);
+
+            LOG4CXX_INFO(g_logger, "Neighbour collect calibration: " << algorithmName(algorithm) << " "
+                         << sampleCount << " samples in " << seconds << " s");
+
+            if (progress)
+                progress->setValue(ImportProgress::MAXIMUM * ((algorithm - 1) * int(NUMBER_OF_CALIBRATION_SAMPLE_COUNTS) + int(index) + 1) / steps);
+        }
+
+        if (progress)
+            progress->setValue(ImportProgress::MAXIMUM * algorithm / NUMBER_OF_ALGORITHMS);
+    }
+
+    return true;
+}
+
+NeighbourCollectProfile NeighbourCollectProfile::load()
+{
+    NeighbourCollectProfile profile;
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "arrangement", "arrangement");
+
+    int size = settings.beginReadArray("neighbourCollectProfile");
+
+    for (int index = 0; index < size; ++index)
+    {
+        settings.setArrayIndex(index);
+
+        int algorithm = settings.value("algorithm").toInt();
+        qulonglong sampleCount = settings.value("sampleCount").toULongLong();
+        double seconds = settings.value("seconds").toDouble();
+
+        // ignore entries of other libcs versions
+        if (algorithm < 1 || algorithm > NUMBER_OF_ALGORITHMS || !sampleCount || seconds <= 0)
+            continue;
+
+        profile.setCost(algorithm, static_cast<size_t>(sampleCount), seconds);
+    }
+
+    settings.endArray();
+
+    return profile;
+}
+
+void NeighbourCollectProfile::save() const
+{
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "arrangement", "arrangement");
+
+    settings.remove("neighbourCollectProfile");
+    settings.beginWriteArray("neighbourCollectProfile");
+
+    int index = 0;
+
+    for (int algorithm = 1; algorithm <= NUMBER_OF_ALGORITHMS; ++algorithm)
+    {
+        for (Costs::const_iterator it = m_costs[algorithm - 1].begin(); it != m_costs[algorithm - 1].end(); ++it)
+        {
+            settings.setArrayIndex(index++);
+            settings.setValue("algorithm", algorithm);
+            settings.setValue("sampleCount", static_cast<qulonglong>(it->first));
+            settings.setValue("seconds", it->second);
+        }
+    }
+
+    settings.endArray();
+}
+
+std::string NeighbourCollectProfile::algorithmName(int algorithm)
+{
+    switch (algorithm)
+    {
+    case 1: return "naive";
+    case 2: return "optimized";
+    case 3: return "optimal";
+    }
+
+    return "unknown";
+}
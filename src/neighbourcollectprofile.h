@@ -0,0 +1,66 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef NEIGHBOURCOLLECTPROFILE_H
+#define NEIGHBOURCOLLECTPROFILE_H
+
+#include <map>
+#include <string>
+
+class ImportProgress;
+
+// measured cost of the cell neighbour collect algorithms of libcs on this
+// host; algorithms are numbered as in CS::Config, from 1
+class NeighbourCollectProfile
+{
+public:
+    static const int NUMBER_OF_ALGORITHMS = 3;
+    static const double DEFAULT_TIME_LIMIT;         // seconds per measurement
+
+    NeighbourCollectProfile();
+
+    bool                isEmpty() const;
+
+    void                setCost(int algorithm, size_t sampleCount, double seconds);
+
+    // interpolated over the measured sample counts, negative if unknown
+    double              expectedCost(int algorithm, size_t sampleCount) const;
+
+    // cheapest algorithm for a sample count, among those measured that far
+    // if there are any; 0 if nothing was measured
+    int                 fastest(size_t sampleCount, double *cost = 0) const;
+
+    // time every algorithm on a small scene for growing sample counts;
+    // a count is not tried once the last two measurements predict it to
+    // exceed the time limit; false if cancelled through the progress
+    bool                calibrate(ImportProgress *progress = 0, double timeLimit = DEFAULT_TIME_LIMIT);
+
+    // stored per user, shared by all scenes
+    static NeighbourCollectProfile load();
+    void                save() const;
+
+    static std::string  algorithmName(int algorithm);
+
+private:
+    typedef std::map<size_t, double> Costs;
+
+    Costs               m_costs[NUMBER_OF_ALGORITHMS];
+};
+
+#endif // NEIGHBOURCOLLECTPROFILE_H
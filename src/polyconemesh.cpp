@@ -21,6 +21,7 @@
 #include <GL/gle.h>
 #include <GL/gl.h>
 #include <boost/scoped_array.hpp>
+#include <cmath>
 
 PolyConeMesh::PolyConeMesh(QGLWidget *gl, Qsic_spin_list_3_Z_ptr spinList, double radius, int sides)
     : Mesh(gl),
@@ -42,7 +43,7 @@ void PolyConeMesh::drawMesh()
         points[index][0] = iterator->s12();
         points[index][1] = iterator->s23();
         points[index][2] = iterator->s31();
-        radiuses[index] = m_radius * ((iterator->s0() + 1.0) * 0.5 * 0.75 + 0.25);   // [-1; 1] -> [25% QSIC_SIZE; 100 % QSIC_SIZE]
+        radiuses[index] = m_radius * (std::fabs(iterator->s0()) * 0.75 + 0.25);   // |s0| [0; 1] -> [25% QSIC_SIZE; 100 % QSIC_SIZE], same for the antipodal image
         ++index;
     }
 
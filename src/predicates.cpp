@@ -86,10 +86,10 @@ void PredicateS::on_pushButtonRandom_clicked()
     long ax = 0, ay = 0, az = 0;
     long bx = 0, by = 0, bz = 0;
 
-    k.x().longify(kx); k.y().longify(ky); k.z().longify(kz);
-    l.x().longify(lx); l.y().longify(ly); l.z().longify(lz);
-    a.x().longify(ax); a.y().longify(ay); a.z().longify(az);
-    b.x().longify(bx); b.y().longify(by); b.z().longify(bz);
+    kx = zToLong(k.x()); ky = zToLong(k.y()); kz = zToLong(k.z());
+    lx = zToLong(l.x()); ly = zToLong(l.y()); lz = zToLong(l.z());
+    ax = zToLong(a.x()); ay = zToLong(a.y()); az = zToLong(a.z());
+    bx = zToLong(b.x()); by = zToLong(b.y()); bz = zToLong(b.z());
 
     ui->lineEditPointK->setText(QString("%1; %2; %3").arg(kx).arg(ky).arg(kz));
     ui->lineEditPointL->setText(QString("%1; %2; %3").arg(lx).arg(ly).arg(lz));
@@ -20,11 +20,11 @@
 #ifndef QDECIMAL_H
 #define QDECIMAL_H
 
-#include <qdecimal/QDecNumber.hh>
+#include "hybriddecimal.h"
 #include <QDataStream>
 #include <QByteArray>
 
-typedef QDecNumber QDecimal;
+typedef HybridDecimal QDecimal;
 
 inline QDataStream &operator <<(QDataStream &dataStream, const QDecimal &decimal)
 {
@@ -0,0 +1,483 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "radialpruning.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace // anonymous
+{
+// relative widening, far above the rounding error of the conversions below
+const double SHELL_EPSILON = 1e-9;
+
+// multiple of the machine epsilon bounding the rounding of the triangle
+// distance predicates
+const double ROUNDING_ERROR_FACTOR = 64.0;
+
+// number of children of generated inner nodes
+const size_t SHELL_TREE_FANOUT = 8;
+
+struct Vector
+{
+    double x, y, z;
+};
+
+Vector point(const DoubleGeometry &geometry, size_t index)
+{
+    Vector result = { geometry.x()[index], geometry.y()[index], geometry.z()[index] };
+    return result;
+}
+
+Vector operator -(const Vector &left, const Vector &right)
+{
+    Vector result = { left.x - right.x, left.y - right.y, left.z - right.z };
+    return result;
+}
+
+Vector operator +(const Vector &left, const Vector &right)
+{
+    Vector result = { left.x + right.x, left.y + right.y, left.z + right.z };
+    return result;
+}
+
+Vector operator *(const Vector &left, double right)
+{
+    Vector result = { left.x * right, left.y * right, left.z * right };
+    return result;
+}
+
+double dot(const Vector &left, const Vector &right)
+{
+    return left.x * right.x + left.y * right.y + left.z * right.z;
+}
+
+double length(const Vector &vector)
+{
+    return std::sqrt(dot(vector, vector));
+}
+
+Vector cross(const Vector &left, const Vector &right)
+{
+    Vector result = { left.y * right.z - left.z * right.y,
+                      left.z * right.x - left.x * right.z,
+                      left.x * right.y - left.y * right.x };
+    return result;
+}
+
+// error bound of the sums of products below, relative to the product of
+// the input lengths; a few rounding steps each, with a wide margin
+double roundingError(double magnitude)
+{
+    return ROUNDING_ERROR_FACTOR * std::numeric_limits<double>::epsilon() * magnitude;
+}
+
+// lower bound of the distance from the origin to segment ab
+double segmentDistanceLowerBound(const Vector &a, const Vector &b)
+{
+    Vector ab = b - a;
+    double squaredLength = dot(ab, ab);
+    double t = squaredLength > 0 ? std::min(1.0, std::max(0.0, -dot(a, ab) / squaredLength)) : 0.0;
+
+    // any point of the segment is a valid candidate, only the rounding of
+    // the point and its length counts
+    double distance = length(a + ab * t);
+    return distance - roundingError(length(a) + length(b));
+}
+
+// lower bound of the distance from the origin to triangle abc
+//
+// the closest point is inside the triangle, where the plane distance is
+// exact, or on an edge; the edges are used only if the projected origin
+// is provably outside one of them, so slivers never overestimate
+double triangleDistanceLowerBound(const Vector &a, const Vector &b, const Vector &c)
+{
+    Vector ab = b - a;
+    Vector ac = c - a;
+    Vector n = cross(ab, ac);
+
+    // errors of n scale with the edges, not with n itself
+    double normalError = roundingError(length(ab) * length(ac));
+
+    const Vector *vertices[] = { &a, &b, &c };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const Vector &u = *vertices[i];
+        const Vector &v = *vertices[(i + 1) % 3];
+
+        // the origin projects outside edge uv if the triple product is negative
+        double side = dot(n, cross(u, v));
+        double sideError = normalError * length(u) * length(v) + roundingError(length(n) * length(u) * length(v));
+
+        if (side < -sideError)
+        {
+            return std::min(segmentDistanceLowerBound(a, b),
+                            std::min(segmentDistanceLowerBound(b, c),
+                                     segmentDistanceLowerBound(c, a)));
+        }
+    }
+
+    // plane distance |n.a| / |n| with the numerator rounded down and the
+    // denominator rounded up; zero for degenerate triangles
+    double numerator = std::fabs(dot(n, a)) - (normalError * length(a) + roundingError(length(n) * length(a)));
+    double denominator = length(n) + normalError;
+
+    if (numerator <= 0 || denominator <= 0)
+        return 0;
+
+    return numerator / denominator;
+}
+
+RadialShell widenedShell(double minimum, double maximum)
+{
+    double epsilon = SHELL_EPSILON * std::max(1.0, maximum);
+    return RadialShell(std::max(0.0, minimum - epsilon), maximum + epsilon);
+}
+
+// for each shell count how many of the sorted other shells it overlaps
+unsigned long long countOverlaps(const RadialShellList &shells,
+                                 const RadialShellList &others,
+                                 std::vector<bool> &kept)
+{
+    std::vector<double> otherMinimums;
+    std::vector<double> otherMaximums;
+
+    otherMinimums.reserve(others.size());
+    otherMaximums.reserve(others.size());
+
+    for (RadialShellList::const_iterator it = others.begin(); it != others.end(); ++it)
+    {
+        otherMinimums.push_back(it->minimum());
+        otherMaximums.push_back(it->maximum());
+    }
+
+    std::sort(otherMinimums.begin(), otherMinimums.end());
+    std::sort(otherMaximums.begin(), otherMaximums.end());
+
+    unsigned long long pairs = 0;
+
+    kept.assign(shells.size(), false);
+
+    for (size_t i = 0; i < shells.size(); ++i)
+    {
+        // shells starting not after our end, minus those ending before our start
+        size_t startingBefore = std::upper_bound(otherMinimums.begin(), otherMinimums.end(), shells[i].maximum()) - otherMinimums.begin();
+        size_t endingBefore = std::lower_bound(otherMaximums.begin(), otherMaximums.end(), shells[i].minimum()) - otherMaximums.begin();
+        size_t overlapping = startingBefore - endingBefore;
+
+        kept[i] = overlapping > 0;
+        pairs += overlapping;
+    }
+
+    return pairs;
+}
+
+struct ShellMidpointLess
+{
+    const RadialShellList *shells;
+
+    bool operator ()(size_t left, size_t right) const
+    {
+        return (*shells)[left].minimum() + (*shells)[left].maximum() < (*shells)[right].minimum() + (*shells)[right].maximum();
+    }
+};
+
+struct NodePair
+{
+    const RadialShellTree * movable;
+    size_t                  movableNode;
+    const RadialShellTree * obstacle;
+    size_t                  obstacleNode;
+};
+
+double shellWidth(const RadialShell &shell)
+{
+    return shell.maximum() - shell.minimum();
+}
+} // namespace anonymous
+
+RadialShell::RadialShell()
+    : m_minimum(0),
+      m_maximum(0)
+{
+}
+
+RadialShell::RadialShell(double minimum, double maximum)
+    : m_minimum(minimum),
+      m_maximum(maximum)
+{
+}
+
+double RadialShell::minimum() const
+{
+    return m_minimum;
+}
+
+double RadialShell::maximum() const
+{
+    return m_maximum;
+}
+
+bool RadialShell::overlaps(const RadialShell &other) const
+{
+    return m_minimum <= other.m_maximum && other.m_minimum <= m_maximum;
+}
+
+RadialShell radialShell(const DoubleGeometry &geometry, size_t ball)
+{
+    double distance = length(point(geometry, ball));
+    double radius = geometry.radii()[ball];
+
+    return widenedShell(distance - radius, distance + radius);
+}
+
+RadialShell radialShell(const DoubleGeometry &geometry, const DecimalFace &face)
+{
+    Vector a = point(geometry, face.vertex(0));
+    Vector b = point(geometry, face.vertex(1));
+    Vector c = point(geometry, face.vertex(2));
+
+    double maximum = std::max(length(a), std::max(length(b), length(c)));
+    double minimum = triangleDistanceLowerBound(a, b, c);
+
+    return widenedShell(minimum, maximum);
+}
+
+unsigned long long radialPrune(const RadialShellList &movable,
+                               const RadialShellList &obstacles,
+                               std::vector<bool> &movableKept,
+                               std::vector<bool> &obstaclesKept)
+{
+    unsigned long long pairs = countOverlaps(movable, obstacles, movableKept);
+    countOverlaps(obstacles, movable, obstaclesKept);
+
+    return pairs;
+}
+
+RadialShellTree::RadialShellTree(const RadialShellList &shells, size_t firstPrimitive)
+{
+    std::vector<size_t> level(shells.size());
+
+    for (size_t i = 0; i < shells.size(); ++i)
+        level[i] = addNode(shells[i], false, static_cast<int>(firstPrimitive + i));
+
+    // neighbouring shells end up below the same inner node
+    ShellMidpointLess less = { &shells };
+    std::sort(level.begin(), level.end(), less);
+
+    while (level.size() > 1)
+    {
+        std::vector<size_t> nextLevel;
+
+        for (size_t i = 0; i < level.size(); i += SHELL_TREE_FANOUT)
+        {
+            std::vector<size_t> children(level.begin() + i, level.begin() + std::min(i + SHELL_TREE_FANOUT, level.size()));
+            nextLevel.push_back(addInnerNode(children));
+        }
+
+        level.swap(nextLevel);
+    }
+
+    m_root = level.empty() ? addInnerNode(level) : level.front();
+}
+
+RadialShellTree::RadialShellTree(const DecimalBallTree &tree, const DoubleGeometry &geometry, size_t firstPrimitive)
+{
+    std::vector<size_t> roots;
+
+    for (size_t i = 0; i < tree.numberOfNodes(); ++i)
+    {
+        int leaf = tree.leaf(i);
+
+        if (leaf != DecimalBallTree::NO_NODE)
+            addNode(radialShell(geometry, static_cast<size_t>(leaf)), false, static_cast<int>(firstPrimitive) + leaf);
+        else
+            addNode(RadialShell(), true, -1);
+
+        if (tree.parent(i) == DecimalBallTree::NO_NODE)
+            roots.push_back(i);
+    }
+
+    for (size_t i = 0; i < tree.numberOfNodes(); ++i)
+    {
+        std::vector<size_t> children;
+
+        for (size_t j = 0; j < tree.numberOfChildren(i); ++j)
+            children.push_back(tree.firstChild(i) + j);
+
+        setChildren(i, children);
+    }
+
+    // children are stored after their parents
+    for (size_t i = tree.numberOfNodes(); i > 0; --i)
+        if (m_nodes[i - 1].primitive == -1)
+            updateHull(i - 1);
+
+    m_root = addInnerNode(roots);
+}
+
+size_t RadialShellTree::root() const
+{
+    return m_root;
+}
+
+const RadialShell &RadialShellTree::shell(size_t node) const
+{
+    return m_nodes[node].shell;
+}
+
+bool RadialShellTree::isEmpty(size_t node) const
+{
+    return m_nodes[node].empty;
+}
+
+int RadialShellTree::primitive(size_t node) const
+{
+    return m_nodes[node].primitive;
+}
+
+size_t RadialShellTree::numberOfChildren(size_t node) const
+{
+    return m_nodes[node].numberOfChildren;
+}
+
+size_t RadialShellTree::child(size_t node, size_t index) const
+{
+    return m_children[m_nodes[node].firstChild + index];
+}
+
+size_t RadialShellTree::addNode(const RadialShell &shell, bool empty, int primitive)
+{
+    Node node;
+    node.shell = shell;
+    node.empty = empty;
+    node.primitive = primitive;
+    node.firstChild = 0;
+    node.numberOfChildren = 0;
+
+    m_nodes.push_back(node);
+    return m_nodes.size() - 1;
+}
+
+size_t RadialShellTree::addInnerNode(const std::vector<size_t> &children)
+{
+    size_t node = addNode(RadialShell(), true, -1);
+
+    setChildren(node, children);
+    updateHull(node);
+
+    return node;
+}
+
+void RadialShellTree::setChildren(size_t node, const std::vector<size_t> &children)
+{
+    m_nodes[node].firstChild = m_children.size();
+    m_nodes[node].numberOfChildren = children.size();
+
+    m_children.insert(m_children.end(), children.begin(), children.end());
+}
+
+void RadialShellTree::updateHull(size_t node)
+{
+    bool empty = true;
+    double minimum = 0;
+    double maximum = 0;
+
+    for (size_t i = 0; i < m_nodes[node].numberOfChildren; ++i)
+    {
+        const Node &childNode = m_nodes[child(node, i)];
+
+        if (childNode.empty)
+            continue;
+
+        minimum = empty ? childNode.shell.minimum() : std::min(minimum, childNode.shell.minimum());
+        maximum = empty ? childNode.shell.maximum() : std::max(maximum, childNode.shell.maximum());
+        empty = false;
+    }
+
+    m_nodes[node].shell = RadialShell(minimum, maximum);
+    m_nodes[node].empty = empty;
+}
+
+unsigned long long radialPrune(const RadialShellTreeList &movable,
+                               const RadialShellTreeList &obstacles,
+                               std::vector<bool> &movableKept,
+                               std::vector<bool> &obstaclesKept)
+{
+    std::vector<NodePair> stack;
+
+    for (RadialShellTreeList::const_iterator movableIterator = movable.begin(); movableIterator != movable.end(); ++movableIterator)
+    {
+        for (RadialShellTreeList::const_iterator obstacleIterator = obstacles.begin(); obstacleIterator != obstacles.end(); ++obstacleIterator)
+        {
+            NodePair pair = { &*movableIterator, movableIterator->root(), &*obstacleIterator, obstacleIterator->root() };
+            stack.push_back(pair);
+        }
+    }
+
+    unsigned long long pairs = 0;
+
+    while (!stack.empty())
+    {
+        NodePair pair = stack.back();
+        stack.pop_back();
+
+        if (pair.movable->isEmpty(pair.movableNode) || pair.obstacle->isEmpty(pair.obstacleNode))
+            continue;
+
+        const RadialShell &movableShell = pair.movable->shell(pair.movableNode);
+        const RadialShell &obstacleShell = pair.obstacle->shell(pair.obstacleNode);
+
+        if (!movableShell.overlaps(obstacleShell))
+            continue;
+
+        size_t movableChildren = pair.movable->numberOfChildren(pair.movableNode);
+        size_t obstacleChildren = pair.obstacle->numberOfChildren(pair.obstacleNode);
+
+        // both leaves
+        if (!movableChildren && !obstacleChildren)
+        {
+            movableKept[static_cast<size_t>(pair.movable->primitive(pair.movableNode))] = true;
+            obstaclesKept[static_cast<size_t>(pair.obstacle->primitive(pair.obstacleNode))] = true;
+            ++pairs;
+            continue;
+        }
+
+        // descend into the wider shell
+        if (movableChildren && (!obstacleChildren || shellWidth(movableShell) >= shellWidth(obstacleShell)))
+        {
+            for (size_t i = 0; i < movableChildren; ++i)
+            {
+                NodePair childPair = { pair.movable, pair.movable->child(pair.movableNode, i), pair.obstacle, pair.obstacleNode };
+                stack.push_back(childPair);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < obstacleChildren; ++i)
+            {
+                NodePair childPair = { pair.movable, pair.movableNode, pair.obstacle, pair.obstacle->child(pair.obstacleNode, i) };
+                stack.push_back(childPair);
+            }
+        }
+    }
+
+    return pairs;
+}
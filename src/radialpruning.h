@@ -0,0 +1,115 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RADIALPRUNING_H
+#define RADIALPRUNING_H
+
+#include "decimalscene.h"
+#include "doublegeometry.h"
+#include <vector>
+
+// spherical shell [minimum, maximum] swept by a primitive rotating
+// about the origin; primitives with disjoint shells never collide
+//
+// shells are computed from the double geometry of the object and
+// widened, so they always contain the exact shell of the decimal primitive
+class RadialShell
+{
+public:
+    RadialShell();
+    RadialShell(double minimum, double maximum);
+
+    double  minimum() const;
+    double  maximum() const;
+
+    bool    overlaps(const RadialShell &other) const;
+
+private:
+    double  m_minimum;
+    double  m_maximum;
+};
+
+typedef std::vector<RadialShell> RadialShellList;
+
+// shell of a ball or of a mesh face of the geometry
+RadialShell radialShell(const DoubleGeometry &geometry, size_t ball);
+RadialShell radialShell(const DoubleGeometry &geometry, const DecimalFace &face);
+
+// shell hierarchy over the primitives of one object
+//
+// inner nodes are bounded by the hull of their children, as sphere tree
+// parents do not always enclose their children
+class RadialShellTree
+{
+public:
+    // groups a flat list of shells of consecutive primitives
+    RadialShellTree(const RadialShellList &shells, size_t firstPrimitive);
+
+    // follows the given hierarchy, leaves index consecutive primitives;
+    // the geometry is the one of the ball list the leaves refer to
+    RadialShellTree(const DecimalBallTree &tree, const DoubleGeometry &geometry, size_t firstPrimitive);
+
+    size_t                  root() const;
+
+    const RadialShell &     shell(size_t node) const;
+    bool                    isEmpty(size_t node) const;
+
+    // primitive index of a leaf, -1 for inner nodes
+    int                     primitive(size_t node) const;
+
+    size_t                  numberOfChildren(size_t node) const;
+    size_t                  child(size_t node, size_t index) const;
+
+private:
+    struct Node
+    {
+        RadialShell     shell;
+        bool            empty;
+        int             primitive;
+        size_t          firstChild;
+        size_t          numberOfChildren;
+    };
+
+    std::vector<Node>       m_nodes;
+    std::vector<size_t>     m_children;
+    size_t                  m_root;
+
+    size_t                  addNode(const RadialShell &shell, bool empty, int primitive);
+    size_t                  addInnerNode(const std::vector<size_t> &children);
+    void                    setChildren(size_t node, const std::vector<size_t> &children);
+    void                    updateHull(size_t node);
+};
+
+typedef std::vector<RadialShellTree> RadialShellTreeList;
+
+// mark primitives which overlap at least one primitive of the other set;
+// returns the number of overlapping movable/obstacle pairs
+unsigned long long radialPrune(const RadialShellList &movable,
+                               const RadialShellList &obstacles,
+                               std::vector<bool> &movableKept,
+                               std::vector<bool> &obstaclesKept);
+
+// same, descending both hierarchies only where their shells overlap;
+// kept flags must be sized to the number of primitives
+unsigned long long radialPrune(const RadialShellTreeList &movable,
+                               const RadialShellTreeList &obstacles,
+                               std::vector<bool> &movableKept,
+                               std::vector<bool> &obstaclesKept);
+
+#endif // RADIALPRUNING_H
@@ -25,6 +25,7 @@
 #include "ispoweroftwo.h"
 #include "compressor.h"
 #include "genericrouter.h"
+#include "voxelstore.h"
 #include "volumerenderer.h"
 #include "volumerenderertexture3d.h"
 #include "volumerenderergaussiansplatter.h"
@@ -52,6 +53,10 @@ struct RasterConfigurationSpaceTag
 class RasterConfigurationSpace
     : public ConfigurationSpace
 {
+    // stream format of paged rasters; legacy streams start with a non-zero resolution
+    static const uint STREAM_PAGED_MARKER = 0;
+    static const uint STREAM_PAGED_VERSION = 1;
+
 public:
     template<class Configuration_, typename InputIterator>
     RasterConfigurationSpace(const RasterConfigurationSpaceTag<Configuration_> &,
@@ -73,73 +78,52 @@ public:
         // create configuration space for given representation
         GenericRouter<Configuration> *rasterRouter = new GenericRouter<Configuration>();
 
-        rasterRouter->configuration().create_from_scene(robot_begin, robot_end,
-                                                        obstacle_begin, obstacle_end,
-                                                        parameters);
+        {
+            QMutexLocker locker(&kernelMutex());
+
+            rasterRouter->configuration().create_from_scene(robot_begin, robot_end,
+                                                            obstacle_begin, obstacle_end,
+                                                            parameters);
+        }
 
         // assume that the representation is raster
         const Representation &rep = rasterRouter->configuration().rep();
 
         // prepare voxels
         m_resolution = rep.resolution();
-        m_voxels.reset(new VoxelType[m_resolution * m_resolution * m_resolution]);
+        size_t count = m_resolution * m_resolution * m_resolution;
+        m_voxels.reset(new VoxelStore(count));
 
         size_t index = 0;
 
-        // scan points
-        for (size_t u = 0; u < m_resolution; ++u)
+        // scan points of one half, the voxel at -x covers the same rotations
+        // with opposite signs of s0 so it has the same type; the resolution
+        // is even, so the halves u < R/2 and u >= R/2 are exact mirrors
+        for (size_t u = 0; u < m_resolution / 2; ++u)
         {
             for (size_t v = 0; v < m_resolution; ++v)
             {
                 for (size_t w = 0; w < m_resolution; ++w)
                 {
-                    if (u == 0 || v == 0 || w == 0 || u == m_resolution - 1 || v == m_resolution - 1 || w == m_resolution - 1)
+                    VoxelType voxelType;
+
+                    if (u == 0 || v == 0 || w == 0 || v == m_resolution - 1 || w == m_resolution - 1)
                     {
-                        m_voxels[index++] = VoxelType_Border;
+                        voxelType = VoxelType_Border;
                     }
                     else
                     {
-                        const typename Representation::Voxel &voxel = rep.voxel(u, v, w);
-
-                        if (!voxel.is_real())
-                        {
-                            m_voxels[index++] = VoxelType_Imaginary;
-                        }
-                        else
-                        {
-                            if (!voxel.value(CS::Cover_Negative) &&
-                                !voxel.value(CS::Cover_Positive))
-                            {
-                                // empty
-                                m_voxels[index++] = VoxelType_Real_Empty;
-                            }
-                            else if (voxel.value(CS::Cover_Negative) &&
-                                     voxel.value(CS::Cover_Positive))
-                            {
-                                // full
-                                m_voxels[index++] = VoxelType_Real_Full;
-                            }
-                            else
-                            {
-                                // mixed
-                                m_voxels[index++] = VoxelType_Real_Mixed;
-                            }
-                        }
+                        voxelType = classifyVoxel(rep.voxel(u, v, w));
                     }
+
+                    m_voxels->set(index, voxelType);
+                    m_voxels->set(count - 1 - index, voxelType);
+                    ++index;
                 }
             }
         }
 
-        switch (volumeRendererType)
-        {
-        case VolumeRendererType_Texture3D:
-            m_volumeRenderer.reset(new VolumeRendererTexture3D(m_voxels.get(), m_resolution, m_gl));
-            break;
-
-        case VolumeRendererType_GaussianSplatter:
-            m_volumeRenderer.reset(new VolumeRendererGaussianSplatter(m_voxels.get(), m_resolution, m_gl));
-            break;
-        }
+        createVolumeRenderer(volumeRendererType);
 
         // install route executor
         m_router.reset(rasterRouter);
@@ -152,40 +136,18 @@ public:
         : ConfigurationSpace(gl)
     {
         // read a compressed raster configuration space
-        uint resolution;
-        stream >> resolution;
-
-        if (stream.status() != QDataStream::Ok)
-            throw std::runtime_error("Failed to load configuration space!");
-
-        m_resolution = static_cast<size_t>(resolution);
-
-        char *data;
-        uint length;
-
-        stream.readBytes(data, length);
+        uint marker;
+        stream >> marker;
 
         if (stream.status() != QDataStream::Ok)
             throw std::runtime_error("Failed to load configuration space!");
 
-        std::string compressed(data, data + length);
-
-        std::string uncompressed;
-        Compressor::decompress(compressed, uncompressed);
+        if (marker == STREAM_PAGED_MARKER)
+            loadPagedFromStream(stream);
+        else
+            loadLegacyFromStream(stream, marker);
 
-        m_voxels.reset(new VoxelType[uncompressed.size()]);
-        memcpy(m_voxels.get(), uncompressed.c_str(), uncompressed.size());
-
-        switch (volumeRendererType)
-        {
-        case VolumeRendererType_Texture3D:
-            m_volumeRenderer.reset(new VolumeRendererTexture3D(m_voxels.get(), m_resolution, m_gl));
-            break;
-
-        case VolumeRendererType_GaussianSplatter:
-            m_volumeRenderer.reset(new VolumeRendererGaussianSplatter(m_voxels.get(), m_resolution, m_gl));
-            break;
-        }
+        createVolumeRenderer(volumeRendererType);
 
         // note: there is no router for a pre-processed raster configuration space
     }
@@ -197,20 +159,29 @@ public:
 
     virtual bool saveToStream(QDataStream &stream)
     {
+        // block by block, so that the whole raster is never resident
+        stream << STREAM_PAGED_MARKER;
+        stream << STREAM_PAGED_VERSION;
         stream << static_cast<uint>(m_resolution);
 
         if (stream.status() != QDataStream::Ok)
             return false;
 
-        std::string uncompressed(reinterpret_cast<char *>(m_voxels.get()),
-                                 reinterpret_cast<char *>(m_voxels.get()) + m_resolution * m_resolution * m_resolution * sizeof(VoxelType));
+        for (size_t block = 0; block < m_voxels->numberOfBlocks(); ++block)
+        {
+            const char *data = reinterpret_cast<const char *>(m_voxels->blockData(block));
+            std::string uncompressed(data, data + m_voxels->blockSize(block));
 
-        std::string compressed;
-        Compressor::compress(uncompressed, compressed);
+            std::string compressed;
+            Compressor::compress(uncompressed, compressed);
 
-        stream.writeBytes(compressed.c_str(), static_cast<uint>(compressed.size()));
+            stream.writeBytes(compressed.c_str(), static_cast<uint>(compressed.size()));
 
-        return stream.status() == QDataStream::Ok;
+            if (stream.status() != QDataStream::Ok)
+                return false;
+        }
+
+        return true;
     }
 
     virtual bool needsLighting() const
@@ -226,7 +197,106 @@ public:
 private:
     boost::scoped_ptr<VolumeRenderer>   m_volumeRenderer;
     size_t                              m_resolution;
-    boost::scoped_array<VoxelType>      m_voxels;
+    boost::scoped_ptr<VoxelStore>       m_voxels;
+
+    template<class Voxel_>
+    static VoxelType classifyVoxel(const Voxel_ &voxel)
+    {
+        if (!voxel.is_real())
+            return VoxelType_Imaginary;
+
+        if (!voxel.value(CS::Cover_Negative) &&
+            !voxel.value(CS::Cover_Positive))
+        {
+            // empty
+            return VoxelType_Real_Empty;
+        }
+        else if (voxel.value(CS::Cover_Negative) &&
+                 voxel.value(CS::Cover_Positive))
+        {
+            // full
+            return VoxelType_Real_Full;
+        }
+        else
+        {
+            // mixed
+            return VoxelType_Real_Mixed;
+        }
+    }
+
+    void createVolumeRenderer(VolumeRendererType volumeRendererType)
+    {
+        switch (volumeRendererType)
+        {
+        case VolumeRendererType_Texture3D:
+            m_volumeRenderer.reset(new VolumeRendererTexture3D(*m_voxels, m_resolution, m_gl));
+            break;
+
+        case VolumeRendererType_GaussianSplatter:
+            m_volumeRenderer.reset(new VolumeRendererGaussianSplatter(*m_voxels, m_resolution, m_gl));
+            break;
+        }
+    }
+
+    static std::string readCompressedBytes(QDataStream &stream)
+    {
+        char *data;
+        uint length;
+
+        stream.readBytes(data, length);
+
+        if (stream.status() != QDataStream::Ok)
+            throw std::runtime_error("Failed to load configuration space!");
+
+        boost::scoped_array<char> guard(data);
+
+        std::string compressed(data, data + length);
+
+        std::string uncompressed;
+        Compressor::decompress(compressed, uncompressed);
+        return uncompressed;
+    }
+
+    void loadPagedFromStream(QDataStream &stream)
+    {
+        uint version, resolution;
+        stream >> version >> resolution;
+
+        if (stream.status() != QDataStream::Ok || version != STREAM_PAGED_VERSION || !isPowerOfTwo(resolution))
+            throw std::runtime_error("Failed to load configuration space!");
+
+        m_resolution = static_cast<size_t>(resolution);
+        m_voxels.reset(new VoxelStore(m_resolution * m_resolution * m_resolution));
+
+        for (size_t block = 0; block < m_voxels->numberOfBlocks(); ++block)
+        {
+            std::string uncompressed = readCompressedBytes(stream);
+
+            if (uncompressed.size() != m_voxels->blockSize(block))
+                throw std::runtime_error("Failed to load configuration space!");
+
+            memcpy(m_voxels->blockData(block), uncompressed.c_str(), uncompressed.size());
+        }
+    }
+
+    void loadLegacyFromStream(QDataStream &stream, uint resolution)
+    {
+        // one compressed array of VoxelType
+        m_resolution = static_cast<size_t>(resolution);
+
+        std::string uncompressed = readCompressedBytes(stream);
+        size_t count = m_resolution * m_resolution * m_resolution;
+
+        if (uncompressed.size() != count * sizeof(VoxelType))
+            throw std::runtime_error("Failed to load configuration space!");
+
+        const VoxelType *voxels = reinterpret_cast<const VoxelType *>(uncompressed.c_str());
+
+        m_voxels.reset(new VoxelStore(count));
+
+        for (size_t index = 0; index < count; ++index)
+            m_voxels->set(index, voxels[index]);
+    }
 };
 
 typedef boost::shared_ptr<RasterConfigurationSpace> RasterConfigurationSpacePtr;
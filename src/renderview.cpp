@@ -353,12 +353,12 @@ void RenderView::drawAxies()
     m_grid->render();
 }
 
-void RenderView::addDecimalTriangleList(DecimalTriangleListPtr triangleList, QColor color)
+void RenderView::addDecimalTriangleList(DecimalTriangleListPtr triangleList, DoubleGeometryPtr geometry, QColor color)
 {
     if (m_triangleLists.find(triangleList) != m_triangleLists.end())
         return;
 
-    TriangleListDataPtr data(new TriangleListData(this, triangleList, color));
+    TriangleListDataPtr data(new TriangleListData(this, triangleList, geometry, color));
     m_triangleLists[triangleList] = data;
 
     updateGL();
@@ -719,12 +719,12 @@ bool RenderView::isSpinVisible(Qsip_spin_3_Z_ptr spin)
     return m_spins[spin];
 }
 
-void RenderView::addDecimalBallList(DecimalBallListPtr ballList, QColor color)
+void RenderView::addDecimalBallList(DecimalBallListPtr ballList, DoubleGeometryPtr geometry, QColor color)
 {
     if (m_ballLists.find(ballList) != m_ballLists.end())
         return;
 
-    BallListDataPtr data(new BallListData(ballList, color));
+    BallListDataPtr data(new BallListData(ballList, geometry, color));
     m_ballLists[ballList] = data;
 
     updateGL();
@@ -791,8 +791,8 @@ void RenderView::removeAllObjects()
     updateGL();
 }
 
-TriangleListData::TriangleListData(QGLWidget *gl, DecimalTriangleListPtr triangleList, QColor color)
-    : m_renderObject(gl, triangleList),
+TriangleListData::TriangleListData(QGLWidget *gl, DecimalTriangleListPtr triangleList, DoubleGeometryPtr geometry, QColor color)
+    : m_renderObject(gl, triangleList, geometry),
       m_color(color)
 {
 }
@@ -892,8 +892,9 @@ void SpinListData::render()
     glPopMatrix();
 }
 
-BallListData::BallListData(DecimalBallListPtr ballList, QColor color)
+BallListData::BallListData(DecimalBallListPtr ballList, DoubleGeometryPtr geometry, QColor color)
     : m_ballList(ballList),
+      m_geometry(geometry),
       m_color(color)
 {
 }
@@ -912,11 +913,13 @@ void BallListData::render(BallMesh *ball)
         applyRotationGL(m_quaternion);
 
         // draw geometry
-        for (DecimalBallList::const_iterator it = m_ballList->begin(); it != m_ballList->end(); ++it)
+        for (size_t i = 0; i < m_geometry->numberOfPoints(); ++i)
         {
+            double radius = m_geometry->radii()[i];
+
             glPushMatrix();
-                glTranslated(it->center().x().toDouble(), it->center().y().toDouble(), it->center().z().toDouble());
-                glScaled(it->radius().toDouble(), it->radius().toDouble(), it->radius().toDouble());
+                glTranslated(m_geometry->x()[i], m_geometry->y()[i], m_geometry->z()[i]);
+                glScaled(radius, radius, radius);
                 applyRotationGL(m_quaternion);
                 ball->render();
             glPopMatrix();
@@ -22,6 +22,7 @@
 
 #include "renderviewcamera.h"
 #include "decimalscene.h"
+#include "doublegeometry.h"
 #include "shader.h"
 #include "gridmesh.h"
 #include "trianglelistmesh.h"
@@ -75,6 +76,7 @@ class TriangleListData
 public:
     TriangleListData(QGLWidget *gl,
                      DecimalTriangleListPtr triangleList,
+                     DoubleGeometryPtr geometry,
                      QColor color);
 
     void    render(bool wireframe);
@@ -112,7 +114,7 @@ class BallListData
     : public MeshData
 {
 public:
-    BallListData(DecimalBallListPtr ballList, QColor color);
+    BallListData(DecimalBallListPtr ballList, DoubleGeometryPtr geometry, QColor color);
 
     void    render(BallMesh *ball);
 
@@ -121,6 +123,7 @@ public:
 
 private:
     DecimalBallListPtr  m_ballList;
+    DoubleGeometryPtr   m_geometry;
     QColor              m_color;
 };
 
@@ -207,7 +210,7 @@ public:
     QColor                      nextSuggestedColor();
 
     // triangle lists
-    void                        addDecimalTriangleList(DecimalTriangleListPtr triangleList, QColor color);
+    void                        addDecimalTriangleList(DecimalTriangleListPtr triangleList, DoubleGeometryPtr geometry, QColor color);
     void                        removeDecimalTriangleList(DecimalTriangleListPtr triangleList);
 
     void                        setDecimalTriangleListVisible(DecimalTriangleListPtr triangleList, bool visible);
@@ -237,7 +240,7 @@ public:
     bool                        isSpinVisible(Qsip_spin_3_Z_ptr spin);
 
     // ball lists
-    void                        addDecimalBallList(DecimalBallListPtr ballList, QColor color);
+    void                        addDecimalBallList(DecimalBallListPtr ballList, DoubleGeometryPtr geometry, QColor color);
     void                        removeDecimalBallList(DecimalBallListPtr ballList);
 
     void                        setDecimalBallListVisible(DecimalBallListPtr ballList, bool visible);
@@ -18,8 +18,164 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "sceneloader.h"
+#include "texttokenizer.h"
 #include "tritripredicatelist.h"
-#include <fstream>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace // anonymous
+{
+// files below this size are parsed on the calling thread
+const qint64 MINIMUM_CHUNK_SIZE = 1 << 20;
+
+// shares of the progress, the rest is building the vertices and faces
+const int COUNTING_PROGRESS = ImportProgress::MAXIMUM * 3 / 10;
+const int PARSING_PROGRESS = ImportProgress::MAXIMUM * 6 / 10;
+
+// a piece of the file which starts and ends between tokens
+//
+// the file is a vertex count, 3 coordinates per vertex, a face count
+// and 3 vertex indices per face; global token numbers tell chunks
+// which part of the file they are in
+struct Chunk
+{
+    const char *        begin;
+    const char *        end;
+    size_t              firstToken;
+    size_t              numberOfTokens;
+    bool                valid;
+};
+
+struct Layout
+{
+    size_t              numberOfVertices;
+    size_t              numberOfFaces;
+
+    size_t              firstCoordinate() const { return 1; }
+    size_t              faceCountToken() const  { return 1 + 3 * numberOfVertices; }
+    size_t              firstIndex() const      { return 2 + 3 * numberOfVertices; }
+    size_t              numberOfTokens() const  { return 2 + 3 * (numberOfVertices + numberOfFaces); }
+};
+
+void countTokens(Chunk *chunk)
+{
+    const char *current = skipSpace(chunk->begin, chunk->end);
+
+    chunk->numberOfTokens = 0;
+
+    while (current != chunk->end)
+    {
+        current = skipSpace(skipToken(current, chunk->end), chunk->end);
+        ++chunk->numberOfTokens;
+    }
+}
+
+void parseTokens(Chunk *chunk, const Layout *layout, QDecimal *coordinates, size_t *indices)
+{
+    const char *current = skipSpace(chunk->begin, chunk->end);
+    size_t token = chunk->firstToken;
+
+    chunk->valid = true;
+
+    while (current != chunk->end && token < layout->numberOfTokens())
+    {
+        const char *tokenEnd = skipToken(current, chunk->end);
+
+        if (token >= layout->firstIndex())
+        {
+            if (!parseSize(current, tokenEnd, indices[token - layout->firstIndex()]))
+                chunk->valid = false;
+        }
+        else if (token >= layout->firstCoordinate() && token < layout->faceCountToken())
+        {
+            parseDecimal(current, tokenEnd, coordinates[token - layout->firstCoordinate()]);
+        }
+
+        current = skipSpace(tokenEnd, chunk->end);
+        ++token;
+    }
+}
+
+// the token with a global number, located with the chunk token counts
+bool findToken(const std::vector<Chunk> &chunks, size_t token, const char **begin, const char **end)
+{
+    for (std::vector<Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        if (token >= it->firstToken + it->numberOfTokens)
+            continue;
+
+        const char *current = skipSpace(it->begin, it->end);
+
+        for (size_t skipped = it->firstToken; skipped < token; ++skipped)
+            current = skipSpace(skipToken(current, it->end), it->end);
+
+        *begin = current;
+        *end = skipToken(current, it->end);
+        return true;
+    }
+
+    return false;
+}
+
+class ChunkJob
+    : public QRunnable
+{
+public:
+    explicit ChunkJob(const boost::function<void ()> &task)
+        : m_task(task)
+    {
+    }
+
+    virtual void run()
+    {
+        m_task();
+    }
+
+private:
+    boost::function<void ()>    m_task;
+};
+
+bool isCancelled(ImportProgress *progress)
+{
+    return progress && progress->isCancelled();
+}
+
+// runs a task on one chunk and reports its share of the stage
+void runChunk(const boost::function<void (Chunk *)> &task, Chunk *chunk, ImportProgress *progress, int share)
+{
+    if (isCancelled(progress))
+    {
+        chunk->valid = false;
+        return;
+    }
+
+    task(chunk);
+
+    if (progress)
+        progress->advance(share);
+}
+
+void runChunks(std::vector<Chunk> &chunks, const boost::function<void (Chunk *)> &task, ImportProgress *progress, int stageProgress)
+{
+    int share = stageProgress / static_cast<int>(chunks.size());
+
+    if (chunks.size() == 1)
+        return runChunk(task, &chunks[0], progress, share);
+
+    QThreadPool pool;
+
+    for (size_t index = 0; index < chunks.size(); ++index)
+        pool.start(new ChunkJob(boost::bind(&runChunk, task, &chunks[index], progress, share)));
+
+    pool.waitForDone();
+}
+} // namespace anonymous
 
 SceneLoader::SceneLoader(const DecimalVectorList &vertices, DecimalFaceList &faces)
     : m_vertices(vertices),
@@ -27,57 +183,113 @@ SceneLoader::SceneLoader(const DecimalVectorList &vertices, DecimalFaceList &fac
 {
 }
 
-SceneLoaderPtr SceneLoader::load(const char *fileName)
+SceneLoaderPtr SceneLoader::load(const char *fileName, ImportProgress *progress)
 {
-    std::ifstream file(fileName);
+    QFile file(QString::fromLocal8Bit(fileName));
 
-    if (!file.is_open())
-        SceneLoaderPtr();
+    if (!file.open(QFile::ReadOnly) || !file.size())
+        return SceneLoaderPtr();
 
-    // parse file
-    size_t num_vertices;
+    // the mapping lives as long as the file object
+    const char *data = reinterpret_cast<const char *>(file.map(0, file.size()));
 
-    if (!(file >> num_vertices))
+    if (!data)
         return SceneLoaderPtr();
 
-    DecimalVectorList vertices;
-    vertices.reserve(num_vertices);
+    const char *dataEnd = data + file.size();
 
-    for (size_t i = 0; i < num_vertices; ++i)
-    {
-        std::string x, y, z;
+    // split at whitespace, one chunk per thread for large files
+    qint64 numberOfChunks = std::max(qint64(1), std::min(qint64(QThread::idealThreadCount()), file.size() / MINIMUM_CHUNK_SIZE));
 
-        // read data as strings
-        if (!(file >> x) || !(file >> y) || !(file >> z))
-            return SceneLoaderPtr();
+    std::vector<Chunk> chunks;
+    const char *chunkBegin = data;
 
-        // and parse to decimals
-        QDecimal decimalX, decimalY, decimalZ;
+    for (qint64 index = 1; index <= numberOfChunks; ++index)
+    {
+        const char *chunkEnd = (index == numberOfChunks) ? dataEnd : skipToken(data + file.size() * index / numberOfChunks, dataEnd);
 
-        decimalX.fromString(x.c_str());
-        decimalY.fromString(y.c_str());
-        decimalZ.fromString(z.c_str());
+        if (chunkEnd < chunkBegin)
+            chunkEnd = chunkBegin;
 
-        vertices.push_back(DecimalVector(decimalX, decimalY, decimalZ));
+        Chunk chunk;
+        chunk.begin = chunkBegin;
+        chunk.end = chunkEnd;
+        chunk.firstToken = 0;
+        chunk.numberOfTokens = 0;
+        chunk.valid = true;
+        chunks.push_back(chunk);
+
+        chunkBegin = chunkEnd;
     }
 
-    size_t num_faces;
+    // number the tokens
+    runChunks(chunks, &countTokens, progress, COUNTING_PROGRESS);
 
-    if (!(file >> num_faces))
+    if (isCancelled(progress))
         return SceneLoaderPtr();
 
-    DecimalFaceList faces;
-    faces.reserve(num_faces);
+    size_t numberOfTokens = 0;
 
-    for (size_t i = 0; i < num_faces; ++i)
+    for (std::vector<Chunk>::iterator it = chunks.begin(); it != chunks.end(); ++it)
     {
-        size_t a, b, c;
+        it->firstToken = numberOfTokens;
+        numberOfTokens += it->numberOfTokens;
+    }
 
-        if (!(file >> a) || !(file >> b) || !(file >> c))
+    // read both counts
+    Layout layout;
+    const char *tokenBegin, *tokenEnd;
+
+    if (!findToken(chunks, 0, &tokenBegin, &tokenEnd) || !parseSize(tokenBegin, tokenEnd, layout.numberOfVertices))
+        return SceneLoaderPtr();
+
+    // every count takes three tokens, checked before the layout multiplies it
+    if (layout.numberOfVertices > numberOfTokens / 3)
+        return SceneLoaderPtr();
+
+    if (numberOfTokens <= layout.faceCountToken())
+        return SceneLoaderPtr();
+
+    if (!findToken(chunks, layout.faceCountToken(), &tokenBegin, &tokenEnd) || !parseSize(tokenBegin, tokenEnd, layout.numberOfFaces))
+        return SceneLoaderPtr();
+
+    if (layout.numberOfFaces > numberOfTokens / 3 - layout.numberOfVertices)
+        return SceneLoaderPtr();
+
+    if (numberOfTokens < layout.numberOfTokens())
+        return SceneLoaderPtr();
+
+    // parse everything in place
+    std::vector<QDecimal> coordinates(3 * layout.numberOfVertices);
+    std::vector<size_t> indices(3 * layout.numberOfFaces);
+
+    runChunks(chunks, boost::bind(&parseTokens, _1, &layout,
+                                  coordinates.empty() ? 0 : &coordinates[0],
+                                  indices.empty() ? 0 : &indices[0]),
+              progress, PARSING_PROGRESS);
+
+    for (std::vector<Chunk>::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+        if (!it->valid)
             return SceneLoaderPtr();
 
-        faces.push_back(DecimalFace(a, b, c));
-    }
+    DecimalVectorList vertices;
+    vertices.reserve(layout.numberOfVertices);
+
+    for (size_t i = 0; i < layout.numberOfVertices; ++i)
+        vertices.push_back(DecimalVector(coordinates[3 * i], coordinates[3 * i + 1], coordinates[3 * i + 2]));
+
+    DecimalFaceList faces;
+    faces.reserve(layout.numberOfFaces);
+
+    for (size_t i = 0; i < indices.size(); ++i)
+        if (indices[i] >= layout.numberOfVertices)
+            return SceneLoaderPtr();
+
+    for (size_t i = 0; i < layout.numberOfFaces; ++i)
+        faces.push_back(DecimalFace(indices[3 * i], indices[3 * i + 1], indices[3 * i + 2]));
+
+    if (progress)
+        progress->setValue(ImportProgress::MAXIMUM);
 
     return SceneLoaderPtr(new SceneLoader(vertices, faces));
 }
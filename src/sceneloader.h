@@ -21,6 +21,7 @@
 #define SCENELOADER_H
 
 #include "decimalscene.h"
+#include "importprogress.h"
 #include <boost/shared_ptr.hpp>
 #include <string>
 
@@ -30,7 +31,8 @@ typedef boost::shared_ptr<SceneLoader> SceneLoaderPtr;
 class SceneLoader
 {
 public:
-    static SceneLoaderPtr       load(const char *fileName);
+    // progress is optional; returns null on errors and when cancelled
+    static SceneLoaderPtr       load(const char *fileName, ImportProgress *progress = 0);
 
     const DecimalVectorList &   vertices() const;
     const DecimalFaceList &     faces() const;
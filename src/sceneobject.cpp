@@ -18,29 +18,153 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "sceneobject.h"
+#include "compressor.h"
+#include "decimalblock.h"
+#include "meshcleanup.h"
+#include "meshimporter.h"
 #include "sceneloader.h"
 #include "spheretreeloader.h"
 #include <cs/Loader_sphere_tree.h>
-#include <QMessageBox>
-#include <QInputDialog>
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QtEndian>
+#include <exception>
+#include <string>
 
 namespace // anonymous
 {
-DecimalTriangleListPtr sceneLoaderObjectToTriangleList(SceneLoaderPtr object)
+// smaller coordinate blocks are stored uncompressed
+const size_t COMPRESSION_MINIMUM_VALUES = 256;
+
+// version 1 arr files store decimals one string at a time
+bool readStringDecimals(QDataStream &dataStream, size_t count, std::vector<QDecimal> &decimals)
 {
-    DecimalTriangleListPtr triangleList(new DecimalTriangleList());
+    // every string starts with its 32-bit length
+    qint64 available = dataStream.device()->bytesAvailable();
+
+    if (available < 0 || count > static_cast<quint64>(available) / sizeof(quint32))
+        return false;
+
+    decimals.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        dataStream >> decimals[i];
+        if (dataStream.status() != QDataStream::Ok) return false;
+    }
+
+    return true;
+}
+
+// face indices as one little-endian array
+void writeFaces(QDataStream &dataStream, const DecimalFaceList &faces)
+{
+    std::string payload(3 * faces.size() * sizeof(quint32), '\0');
+    uchar *data = reinterpret_cast<uchar *>(&payload[0]);
+
+    for (size_t i = 0; i < faces.size(); ++i)
+        for (int v = 0; v < 3; ++v)
+            qToLittleEndian<quint32>(static_cast<quint32>(faces[i].vertex(v)), data + (3 * i + static_cast<size_t>(v)) * sizeof(quint32));
+
+    bool compress = 3 * faces.size() >= COMPRESSION_MINIMUM_VALUES;
+
+    if (compress)
+    {
+        std::string compressed;
+        Compressor::compressPortable(payload, compressed);
+        payload.swap(compressed);
+    }
+
+    dataStream << compress;
+    dataStream.writeBytes(payload.data(), static_cast<uint>(payload.size()));
+}
+
+bool readFaces(QDataStream &dataStream, size_t count, size_t numberOfVertices, DecimalFaceList &faces)
+{
+    bool compressed;
+    dataStream >> compressed;
+    if (dataStream.status() != QDataStream::Ok) return false;
+
+    char *data;
+    uint length;
+
+    dataStream.readBytes(data, length);
+    if (dataStream.status() != QDataStream::Ok) return false;
+
+    std::string payload(data, data + length);
+    delete [] data;
+
+    if (compressed)
+    {
+        std::string uncompressed;
+
+        try
+        {
+            Compressor::decompressPortable(payload, uncompressed);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
 
-    foreach (const DecimalFace &face, object->faces())
+        payload.swap(uncompressed);
+    }
+
+    if (payload.size() != 3 * count * sizeof(quint32))
+        return false;
+
+    const uchar *indices = reinterpret_cast<const uchar *>(payload.data());
+
+    faces.clear();
+    faces.reserve(count);
+
+    for (size_t i = 0; i < count; ++i, indices += 3 * sizeof(quint32))
     {
-        DecimalVector a = object->vertices()[face.vertex(0)];
-        DecimalVector b = object->vertices()[face.vertex(1)];
-        DecimalVector c = object->vertices()[face.vertex(2)];
+        size_t a = qFromLittleEndian<quint32>(indices);
+        size_t b = qFromLittleEndian<quint32>(indices + sizeof(quint32));
+        size_t c = qFromLittleEndian<quint32>(indices + 2 * sizeof(quint32));
+
+        if (a >= numberOfVertices || b >= numberOfVertices || c >= numberOfVertices)
+            return false;
 
-        triangleList->push_back(DecimalTriangle(a, b, c));
+        faces.push_back(DecimalFace(a, b, c));
     }
 
-    return triangleList;
+    return true;
 }
+
+DecimalVectorList decimalsToVertices(const std::vector<QDecimal> &decimals)
+{
+    DecimalVectorList vertices;
+    vertices.reserve(decimals.size() / 3);
+
+    for (size_t i = 0; i + 2 < decimals.size(); i += 3)
+        vertices.push_back(DecimalVector(decimals[i], decimals[i + 1], decimals[i + 2]));
+
+    return vertices;
+}
+
+class TextLoadJob
+    : public QRunnable
+{
+public:
+    TextLoadJob(const std::string &fileName, SceneObjectPtr &result)
+        : m_fileName(fileName),
+          m_result(result)
+    {
+    }
+
+    virtual void run()
+    {
+        m_result = SceneObject::loadFromText(m_fileName.c_str());
+    }
+
+private:
+    std::string         m_fileName;
+    SceneObjectPtr &    m_result;
+};
 } // namespace anonymous
 
 SceneObject::Type SceneObject::type() const
@@ -72,6 +196,48 @@ DecimalTriangleListPtr SceneObject::decimalTriangleList() const
     return m_decimalTriangleList;
 }
 
+DecimalBallTreePtr SceneObject::decimalBallTree() const
+{
+    return m_decimalBallTree;
+}
+
+DoubleGeometryPtr SceneObject::doubleGeometry() const
+{
+    QMutexLocker locker(&m_doubleGeometryMutex);
+
+    if (m_doubleGeometry)
+        return m_doubleGeometry;
+
+    switch (m_type)
+    {
+    case Type_DecimalBallList:
+        m_doubleGeometry.reset(new DoubleGeometry(*m_decimalBallList));
+        break;
+
+    case Type_DecimalTriangleList:
+        m_doubleGeometry.reset(new DoubleGeometry(*m_decimalTriangleList));
+        break;
+    }
+
+    return m_doubleGeometry;
+}
+
+void SceneObject::invalidateDoubleGeometry()
+{
+    QMutexLocker locker(&m_doubleGeometryMutex);
+    m_doubleGeometry.reset();
+}
+
+void SceneObject::cleanUp(bool mergeCoplanar)
+{
+    if (m_type != Type_DecimalTriangleList)
+        return;
+
+    m_decimalTriangleList = cleanUpMesh(*m_decimalTriangleList, mergeCoplanar);
+
+    invalidateDoubleGeometry();
+}
+
 void SceneObject::setRotating(bool rotating)
 {
     m_rotating = rotating;
@@ -102,84 +268,56 @@ QColor SceneObject::color() const
     return m_color;
 }
 
-std::pair<SceneObjectPtr, SceneObjectPtr> SceneObject::loadFromDirectory(const char *directory, QWidget *parent)
+std::pair<SceneObjectPtr, SceneObjectPtr> SceneObject::loadFromDirectory(const char *directory)
 {
-    Q_UNUSED(parent);
-
     std::string obstacleFileName = std::string(directory) + "/" + "obstacle.txt";
     std::string robotFileName = std::string(directory) + "/" + "robot.txt";
 
-    SceneLoaderPtr obstacle = SceneLoader::load(obstacleFileName.c_str());
-    SceneLoaderPtr robot = SceneLoader::load(robotFileName.c_str());
+    // the obstacle loads on a worker while the robot loads here
+    SceneObjectPtr obstacle;
+    QThreadPool pool;
+
+    pool.start(new TextLoadJob(obstacleFileName, obstacle));
+
+    SceneObjectPtr robot = loadFromText(robotFileName.c_str());
+
+    pool.waitForDone();
 
     if (!obstacle || !robot)
         return std::make_pair(SceneObjectPtr(), SceneObjectPtr());
 
-    // convert to triangle lists
-    DecimalTriangleListPtr robotTriangleList = sceneLoaderObjectToTriangleList(robot);
-    DecimalTriangleListPtr obstacleTriangleList = sceneLoaderObjectToTriangleList(obstacle);
-
     // success
-    SceneObjectPtr robotSceneObject(new SceneObject(robotTriangleList));
-    robotSceneObject->setRotating(true);
-
-    SceneObjectPtr obstacleSceneObject(new SceneObject(obstacleTriangleList));
-    obstacleSceneObject->setRotating(false);
+    robot->setRotating(true);
+    obstacle->setRotating(false);
 
-    return std::make_pair(robotSceneObject, obstacleSceneObject);
+    return std::make_pair(robot, obstacle);
 }
 
-SceneObjectPtr SceneObject::loadFromSphereTree(const char *fileName, QWidget *parent)
+SceneObjectPtr SceneObject::loadFromSphereTree(const SphereTreeLoader &loader, size_t level)
 {
-    SphereTreeLoader loader;
-
-    // renormalization
-    bool normalize = QMessageBox::question(parent,
-                                           QObject::tr("Normalize sphere tree"),
-                                           QObject::tr("Do you want to normalize sphere tree to unit box?"),
-                                           QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes;
-
-    if (!loader.loadFromFile(fileName, normalize))
-    {
-        QMessageBox::warning(parent,
-                             QObject::tr("Open sphere tree"),
-                             QObject::tr("Failed to load file"),
-                             QMessageBox::Ok);
-
-        return SceneObjectPtr();
-    }
-
-    // choose level
-    bool ok = false;
+    // keep the hierarchy above the selected level for culling
+    return SceneObjectPtr(new SceneObject(loader.level(level), loader.tree(level)));
+}
 
-    int level = QInputDialog::getInt(parent,
-                                     QObject::tr("Select sphere tree level"),
-                                     QObject::tr("Select level"),
-                                     loader.numberOfLevels() - 1,
-                                     0,
-                                     loader.numberOfLevels() - 1,
-                                     1,
-                                     &ok);
+SceneObjectPtr SceneObject::loadFromText(const char *fileName, ImportProgress *progress)
+{
+    SceneLoaderPtr mesh = SceneLoader::load(fileName, progress);
 
-    if (!ok)
+    if (!mesh)
         return SceneObjectPtr();
 
-    // success
-    return SceneObjectPtr(new SceneObject(DecimalBallListPtr(new DecimalBallList(loader.level(level)))));
+    // keep the mesh indexed
+    return SceneObjectPtr(new SceneObject(DecimalTriangleListPtr(new DecimalTriangleList(mesh->vertices(), mesh->faces()))));
 }
 
-SceneObjectPtr SceneObject::loadFromText(const char *fileName, QWidget *parent)
+SceneObjectPtr SceneObject::loadFromMesh(const char *fileName, ImportProgress *progress)
 {
-    Q_UNUSED(parent);
-
-    SceneLoaderPtr mesh = SceneLoader::load(fileName);
+    MeshImporterPtr mesh = MeshImporter::load(fileName, progress);
 
     if (!mesh)
         return SceneObjectPtr();
 
-    // convert to triangle lists
-    DecimalTriangleListPtr meshTriangleList = sceneLoaderObjectToTriangleList(mesh);
-    return SceneObjectPtr(new SceneObject(meshTriangleList));
+    return SceneObjectPtr(new SceneObject(DecimalTriangleListPtr(new DecimalTriangleList(mesh->vertices(), mesh->faces()))));
 }
 
 void SceneObject::saveToStream(QDataStream &dataStream) const
@@ -187,40 +325,44 @@ void SceneObject::saveToStream(QDataStream &dataStream) const
     // save type
     dataStream << static_cast<int>(m_type);
 
-    // save data
+    // save data, all coordinates in one block
+    std::vector<QDecimal> decimals;
+
     switch (m_type)
     {
     case Type_DecimalBallList:
         dataStream << static_cast<int>(m_decimalBallList->size());
 
+        decimals.reserve(4 * m_decimalBallList->size());
+
         for (DecimalBallList::const_iterator it = m_decimalBallList->begin();
              it != m_decimalBallList->end(); ++it)
         {
-            dataStream << it->center().x();
-            dataStream << it->center().y();
-            dataStream << it->center().z();
-            dataStream << it->radius();
+            decimals.push_back(it->center().x());
+            decimals.push_back(it->center().y());
+            decimals.push_back(it->center().z());
+            decimals.push_back(it->radius());
         }
 
+        DecimalBlock::write(dataStream, decimals, decimals.size() >= COMPRESSION_MINIMUM_VALUES);
         break;
 
     case Type_DecimalTriangleList:
         dataStream << static_cast<int>(m_decimalTriangleList->size());
+        dataStream << static_cast<int>(m_decimalTriangleList->vertices().size());
+
+        decimals.reserve(3 * m_decimalTriangleList->vertices().size());
 
-        for (DecimalTriangleList::const_iterator it = m_decimalTriangleList->begin();
-             it != m_decimalTriangleList->end(); ++it)
+        for (DecimalVectorList::const_iterator it = m_decimalTriangleList->vertices().begin();
+             it != m_decimalTriangleList->vertices().end(); ++it)
         {
-            dataStream << it->vertex(0).x();
-            dataStream << it->vertex(0).y();
-            dataStream << it->vertex(0).z();
-            dataStream << it->vertex(1).x();
-            dataStream << it->vertex(1).y();
-            dataStream << it->vertex(1).z();
-            dataStream << it->vertex(2).x();
-            dataStream << it->vertex(2).y();
-            dataStream << it->vertex(2).z();
+            decimals.push_back(it->x());
+            decimals.push_back(it->y());
+            decimals.push_back(it->z());
         }
 
+        DecimalBlock::write(dataStream, decimals, decimals.size() >= COMPRESSION_MINIMUM_VALUES);
+        writeFaces(dataStream, m_decimalTriangleList->faces());
         break;
     }
 
@@ -230,7 +372,7 @@ void SceneObject::saveToStream(QDataStream &dataStream) const
     dataStream << m_color;
 }
 
-SceneObjectPtr SceneObject::loadFromStream(QDataStream &dataStream)
+SceneObjectPtr SceneObject::loadFromStream(QDataStream &dataStream, ArrVersion version)
 {
     // load type
     int rawType;
@@ -239,37 +381,36 @@ SceneObjectPtr SceneObject::loadFromStream(QDataStream &dataStream)
 
     Type type = static_cast<Type>(rawType);
 
+    int count;
+    dataStream >> count;
+    if (dataStream.status() != QDataStream::Ok || count < 0) return SceneObjectPtr();
+
     // load data
     SceneObjectPtr sceneObject;
+    std::vector<QDecimal> decimals;
 
     switch (type)
     {
     case Type_DecimalBallList:
         {
-            int count;
-            dataStream >> count;
-            if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-            DecimalBallListPtr ballList(new DecimalBallList());
+            size_t numberOfValues = 4 * static_cast<size_t>(count);
 
-            for (int i = 0; i < count; ++i)
+            if (version == ArrVersion_Strings)
             {
-                QDecimal x, y, z, r;
-
-                dataStream >> x;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-                dataStream >> y;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-                dataStream >> z;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+                if (!readStringDecimals(dataStream, numberOfValues, decimals))
+                    return SceneObjectPtr();
+            }
+            else
+            {
+                if (!DecimalBlock::read(dataStream, decimals) || decimals.size() != numberOfValues)
+                    return SceneObjectPtr();
+            }
 
-                dataStream >> r;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+            DecimalBallListPtr ballList(new DecimalBallList());
+            ballList->reserve(static_cast<size_t>(count));
 
-                ballList->push_back(DecimalBall(DecimalVector(x, y, z), r));
-            }
+            for (size_t i = 0; i < decimals.size(); i += 4)
+                ballList->push_back(DecimalBall(DecimalVector(decimals[i], decimals[i + 1], decimals[i + 2]), decimals[i + 3]));
 
             sceneObject.reset(new SceneObject(ballList));
         }
@@ -277,51 +418,42 @@ SceneObjectPtr SceneObject::loadFromStream(QDataStream &dataStream)
 
     case Type_DecimalTriangleList:
         {
-            int count;
-            dataStream >> count;
-            if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+            DecimalVectorList vertices;
+            DecimalFaceList faces;
 
-            DecimalTriangleListPtr triangleList(new DecimalTriangleList());
-
-            for (int i = 0; i < count; ++i)
+            if (version == ArrVersion_Blocks)
             {
-                QDecimal x0, y0, z0, x1, y1, z1, x2, y2, z2;
-
-                dataStream >> x0;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-                dataStream >> y0;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+                int numberOfVertices;
+                dataStream >> numberOfVertices;
+                if (dataStream.status() != QDataStream::Ok || numberOfVertices < 0) return SceneObjectPtr();
 
-                dataStream >> z0;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+                if (!DecimalBlock::read(dataStream, decimals) || decimals.size() != 3 * static_cast<size_t>(numberOfVertices))
+                    return SceneObjectPtr();
 
-                dataStream >> x1;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+                vertices = decimalsToVertices(decimals);
 
-                dataStream >> y1;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-                dataStream >> z1;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-                dataStream >> x2;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
-
-                dataStream >> y2;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+                if (!readFaces(dataStream, static_cast<size_t>(count), vertices.size(), faces))
+                    return SceneObjectPtr();
+            }
+            else
+            {
+                // version 1 stores every triangle with its own vertices
+                if (!readStringDecimals(dataStream, 9 * static_cast<size_t>(count), decimals))
+                    return SceneObjectPtr();
 
-                dataStream >> z2;
-                if (dataStream.status() != QDataStream::Ok) return SceneObjectPtr();
+                vertices = decimalsToVertices(decimals);
+                faces.reserve(static_cast<size_t>(count));
 
-                triangleList->push_back(DecimalTriangle(DecimalVector(x0, y0, z0),
-                                                        DecimalVector(x1, y1, z1),
-                                                        DecimalVector(x2, y2, z2)));
+                for (size_t i = 0; i < vertices.size(); i += 3)
+                    faces.push_back(DecimalFace(i, i + 1, i + 2));
             }
 
-            sceneObject.reset(new SceneObject(triangleList));
+            sceneObject.reset(new SceneObject(DecimalTriangleListPtr(new DecimalTriangleList(vertices, faces))));
         }
         break;
+
+    default:
+        return SceneObjectPtr();
     }
 
     // load other data
@@ -345,9 +477,10 @@ SceneObjectPtr SceneObject::loadFromStream(QDataStream &dataStream)
     return sceneObject;
 }
 
-SceneObject::SceneObject(DecimalBallListPtr ballList)
+SceneObject::SceneObject(DecimalBallListPtr ballList, DecimalBallTreePtr ballTree)
     : m_type(Type_DecimalBallList),
       m_decimalBallList(ballList),
+      m_decimalBallTree(ballTree),
       m_rotating(false),
       m_visible(true)
 {
@@ -22,13 +22,16 @@
 
 #include "kernel.h"
 #include "decimalscene.h"
+#include "doublegeometry.h"
+#include "importprogress.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 #include <utility>
 #include <QString>
 #include <QColor>
+#include <QMutex>
 
-class QWidget;
+class SphereTreeLoader;
 
 class SceneObject;
 typedef boost::shared_ptr<SceneObject> SceneObjectPtr;
@@ -49,6 +52,18 @@ public:
     DecimalBallListPtr      decimalBallList() const;
     DecimalTriangleListPtr  decimalTriangleList() const;
 
+    // hierarchy over decimalBallList(), null if not loaded from a tree
+    DecimalBallTreePtr      decimalBallTree() const;
+
+    // double copy of the geometry for everything but the exact builds,
+    // made on first use; it must be invalidated after any geometry edit
+    DoubleGeometryPtr       doubleGeometry() const;
+    void                    invalidateDoubleGeometry();
+
+    // replaces triangles by their exact cleanup, see cleanUpMesh;
+    // does nothing for balls
+    void                    cleanUp(bool mergeCoplanar);
+
     void                    setRotating(bool rotating);
     bool                    isRotating() const;
 
@@ -58,22 +73,35 @@ public:
     void                    setColor(QColor color);
     QColor                  color() const;
 
-    static std::pair<SceneObjectPtr, SceneObjectPtr>    loadFromDirectory(const char *directory, QWidget *parent);
-    static SceneObjectPtr                               loadFromSphereTree(const char *fileName, QWidget *parent);
-    static SceneObjectPtr                               loadFromText(const char *fileName, QWidget *parent);
+    // loaders run on any thread; progress is optional and null is
+    // returned on errors and when cancelled
+    static std::pair<SceneObjectPtr, SceneObjectPtr>    loadFromDirectory(const char *directory);
+    static SceneObjectPtr                               loadFromSphereTree(const SphereTreeLoader &loader, size_t level);
+    static SceneObjectPtr                               loadFromText(const char *fileName, ImportProgress *progress = 0);
+    static SceneObjectPtr                               loadFromMesh(const char *fileName, ImportProgress *progress = 0);
+
+    // arr format support; objects are always saved in the latest version
+    enum ArrVersion
+    {
+        ArrVersion_Strings = 1,
+        ArrVersion_Blocks = 2
+    };
 
-    // arr format support
     void                                                saveToStream(QDataStream &dataStream) const;
-    static SceneObjectPtr                               loadFromStream(QDataStream &dataStream);
+    static SceneObjectPtr                               loadFromStream(QDataStream &dataStream, ArrVersion version);
 
 private:
-    explicit SceneObject(DecimalBallListPtr decimalBallList);
+    explicit SceneObject(DecimalBallListPtr decimalBallList, DecimalBallTreePtr decimalBallTree = DecimalBallTreePtr());
     explicit SceneObject(DecimalTriangleListPtr decimalTriangleList);
 
     Type                    m_type;
     DecimalBallListPtr      m_decimalBallList;
+    DecimalBallTreePtr      m_decimalBallTree;
     DecimalTriangleListPtr  m_decimalTriangleList;
 
+    mutable QMutex              m_doubleGeometryMutex;
+    mutable DoubleGeometryPtr   m_doubleGeometry;
+
     bool                    m_rotating;
     bool                    m_visible;
 
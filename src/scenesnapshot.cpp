@@ -0,0 +1,471 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "scenesnapshot.h"
+#include "exactsceneconverter.h"
+#include "radialpruning.h"
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <log4cxx/logger.h>
+#include <cassert>
+#include <cstddef>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.scenesnapshot"));
+
+// inexact primitives are read from the double geometry of their objects
+Point_3_R pointR(const DoubleGeometry &geometry, size_t index)
+{
+    return Point_3_R(geometry.x()[index], geometry.y()[index], geometry.z()[index]);
+}
+
+Ball_3_R ballR(const DoubleGeometry &geometry, size_t index)
+{
+    return Ball_3_R(Vector_3_R(geometry.x()[index], geometry.y()[index], geometry.z()[index]), geometry.radii()[index]);
+}
+
+Triangle_3_R triangleR(const DoubleGeometry &geometry, const DecimalFace &face)
+{
+    return Triangle_3_R(pointR(geometry, face.vertex(0)),
+                        pointR(geometry, face.vertex(1)),
+                        pointR(geometry, face.vertex(2)));
+}
+
+void addToConverter(const DecimalVector &vector, ExactSceneConverter &converter)
+{
+    converter.add(vector.x());
+    converter.add(vector.y());
+    converter.add(vector.z());
+}
+
+void addToConverter(const DecimalBall &ball, ExactSceneConverter &converter)
+{
+    addToConverter(ball.center(), converter);
+    converter.add(ball.radius());
+}
+
+void addToConverter(const DecimalTriangle &triangle, ExactSceneConverter &converter)
+{
+    for (int v = 0; v < 3; ++v)
+        addToConverter(triangle.vertex(v), converter);
+}
+
+// values are read back in the order they were added
+Point_3_Z convertedPointZ(const ExactSceneConverter &converter, size_t &index)
+{
+    const Z &x = converter.value(index++);
+    const Z &y = converter.value(index++);
+    const Z &z = converter.value(index++);
+
+    return Point_3_Z(x, y, z);
+}
+
+void appendConverted(const ExactSceneConverter &converter, size_t &index, Ball_list_3_Z &target)
+{
+    const Z &x = converter.value(index++);
+    const Z &y = converter.value(index++);
+    const Z &z = converter.value(index++);
+    const Z &r = converter.value(index++);
+
+    target.push_back(Ball_3_Z(Vector_3_Z(x, y, z), r));
+}
+
+void appendConverted(const ExactSceneConverter &converter, size_t &index, Triangle_list_3_Z &target)
+{
+    Point_3_Z a = convertedPointZ(converter, index);
+    Point_3_Z b = convertedPointZ(converter, index);
+    Point_3_Z c = convertedPointZ(converter, index);
+
+    target.push_back(Triangle_3_Z(a, b, c));
+}
+
+template<typename Primitive>
+void addToConverter(const std::vector<const Primitive *> &primitives, ExactSceneConverter &converter)
+{
+    for (typename std::vector<const Primitive *>::const_iterator it = primitives.begin(); it != primitives.end(); ++it)
+        addToConverter(**it, converter);
+}
+
+template<typename Primitive, typename Target>
+void appendZ(const std::vector<const Primitive *> &primitives, const ExactSceneConverter &converter, size_t &index, Target &target)
+{
+    target.reserve(primitives.size());
+
+    for (size_t i = 0; i < primitives.size(); ++i)
+        appendConverted(converter, index, target);
+}
+
+void addToHash(const DecimalVector &vector, QCryptographicHash &hash)
+{
+    hash.addData(vector.x().toString());
+    hash.addData(" ", 1);
+    hash.addData(vector.y().toString());
+    hash.addData(" ", 1);
+    hash.addData(vector.z().toString());
+    hash.addData(";", 1);
+}
+
+void addToHash(const DecimalBall &ball, QCryptographicHash &hash)
+{
+    addToHash(ball.center(), hash);
+    hash.addData(ball.radius().toString());
+    hash.addData("\n", 1);
+}
+
+void addToHash(const DecimalTriangle &triangle, QCryptographicHash &hash)
+{
+    for (int v = 0; v < 3; ++v)
+        addToHash(triangle.vertex(v), hash);
+
+    hash.addData("\n", 1);
+}
+
+template<typename Primitive>
+void addToHash(const char *name, const std::vector<const Primitive *> &primitives, QCryptographicHash &hash)
+{
+    hash.addData(name);
+    hash.addData(QByteArray::number(static_cast<qulonglong>(primitives.size())));
+    hash.addData("\n", 1);
+
+    for (typename std::vector<const Primitive *>::const_iterator it = primitives.begin(); it != primitives.end(); ++it)
+        addToHash(**it, hash);
+}
+
+// inexact primitives run parallel to the decimal ones
+template<typename Primitive, typename Inexact>
+void removeUnkept(std::vector<const Primitive *> &primitives, Inexact &inexact, const std::vector<bool> &kept)
+{
+    size_t count = 0;
+
+    for (size_t i = 0; i < primitives.size(); ++i)
+    {
+        if (kept[i])
+        {
+            primitives[count] = primitives[i];
+            inexact[count] = inexact[i];
+            ++count;
+        }
+    }
+
+    primitives.resize(count);
+    inexact.erase(inexact.begin() + static_cast<std::ptrdiff_t>(count), inexact.end());
+}
+
+template<typename Primitive, typename Inexact>
+void applyPruning(std::vector<const Primitive *> &movable, std::vector<const Primitive *> &obstacles,
+                Inexact &movableInexact, Inexact &obstaclesInexact,
+                const std::vector<bool> &movableKept, const std::vector<bool> &obstaclesKept,
+                unsigned long long pairs, unsigned long long overlappingPairs)
+{
+    // nothing can collide, keep the scene as it is so it is not empty
+    if (!overlappingPairs)
+    {
+        LOG4CXX_INFO(g_logger, "Radial pruning: no primitives can collide, scene left unpruned");
+        return;
+    }
+
+    removeUnkept(movable, movableInexact, movableKept);
+    removeUnkept(obstacles, obstaclesInexact, obstaclesKept);
+
+    unsigned long long remainingPairs = static_cast<unsigned long long>(movable.size()) * obstacles.size();
+
+    LOG4CXX_INFO(g_logger, "Radial pruning: " << movable.size() << " movable and "
+                 << obstacles.size() << " obstacle primitives kept, "
+                 << (pairs - remainingPairs) << " of " << pairs << " pairs removed, "
+                 << overlappingPairs << " pairs with overlapping shells");
+}
+
+// shells run parallel to the primitives
+template<typename Primitive, typename Inexact>
+void pruneRadially(std::vector<const Primitive *> &movable, std::vector<const Primitive *> &obstacles,
+                   Inexact &movableInexact, Inexact &obstaclesInexact,
+                   const RadialShellList &movableShells, const RadialShellList &obstacleShells)
+{
+    if (movable.empty() || obstacles.empty())
+        return;
+
+    std::vector<bool> movableKept;
+    std::vector<bool> obstaclesKept;
+
+    unsigned long long pairs = static_cast<unsigned long long>(movable.size()) * obstacles.size();
+    unsigned long long overlappingPairs = radialPrune(movableShells, obstacleShells, movableKept, obstaclesKept);
+
+    applyPruning(movable, obstacles, movableInexact, obstaclesInexact, movableKept, obstaclesKept, pairs, overlappingPairs);
+}
+} // namespace anonymous
+
+SceneSnapshot::SceneSnapshot(const std::vector<SceneObjectPtr> &sceneObjects, SceneObject::Type type, unsigned int version)
+    : m_type(type),
+      m_version(version),
+      m_exactReady(false),
+      m_exactTruncated(false)
+{
+    for (SceneObjects::const_iterator sceneObjectIterator = sceneObjects.begin();
+         sceneObjectIterator != sceneObjects.end(); ++sceneObjectIterator)
+    {
+        assert((*sceneObjectIterator)->type() == type);
+
+        bool movable = (*sceneObjectIterator)->isRotating();
+        DoubleGeometryPtr geometry = (*sceneObjectIterator)->doubleGeometry();
+
+        switch (m_type)
+        {
+        case SceneObject::Type_DecimalBallList:
+            {
+                m_ballLists.push_back((*sceneObjectIterator)->decimalBallList());
+                const DecimalBallList &ballList = *m_ballLists.back();
+
+                for (size_t i = 0; i < ballList.size(); ++i)
+                {
+                    (movable ? m_movableBalls : m_obstacleBalls).push_back(&ballList[i]);
+                    (movable ? m_movableBallsR : m_obstacleBallsR).push_back(ballR(*geometry, i));
+                }
+            }
+            break;
+
+        case SceneObject::Type_DecimalTriangleList:
+            {
+                m_triangleLists.push_back((*sceneObjectIterator)->decimalTriangleList());
+                const DecimalTriangleList &triangleList = *m_triangleLists.back();
+                size_t i = 0;
+
+                for (DecimalTriangleList::const_iterator triangleIterator = triangleList.begin();
+                     triangleIterator != triangleList.end(); ++triangleIterator, ++i)
+                {
+                    (movable ? m_movableTriangles : m_obstacleTriangles).push_back(&*triangleIterator);
+                    (movable ? m_movableTrianglesR : m_obstacleTrianglesR).push_back(triangleR(*geometry, triangleList.face(i)));
+                }
+            }
+            break;
+        }
+    }
+
+    m_numberOfMovable = m_movableBalls.size() + m_movableTriangles.size();
+    m_numberOfObstacles = m_obstacleBalls.size() + m_obstacleTriangles.size();
+
+    prune(sceneObjects);
+    computeHash();
+}
+
+SceneObject::Type SceneSnapshot::type() const
+{
+    return m_type;
+}
+
+unsigned int SceneSnapshot::version() const
+{
+    return m_version;
+}
+
+const std::string &SceneSnapshot::hash() const
+{
+    return m_hash;
+}
+
+size_t SceneSnapshot::numberOfMovable() const
+{
+    return m_numberOfMovable;
+}
+
+size_t SceneSnapshot::numberOfObstacles() const
+{
+    return m_numberOfObstacles;
+}
+
+const Ball_list_3_R &SceneSnapshot::movableBallsR() const
+{
+    return m_movableBallsR;
+}
+
+const Ball_list_3_R &SceneSnapshot::obstacleBallsR() const
+{
+    return m_obstacleBallsR;
+}
+
+const Triangle_list_3_R &SceneSnapshot::movableTrianglesR() const
+{
+    return m_movableTrianglesR;
+}
+
+const Triangle_list_3_R &SceneSnapshot::obstacleTrianglesR() const
+{
+    return m_obstacleTrianglesR;
+}
+
+const Ball_list_3_Z &SceneSnapshot::movableBallsZ() const
+{
+    ensureExact();
+    return m_movableBallsZ;
+}
+
+const Ball_list_3_Z &SceneSnapshot::obstacleBallsZ() const
+{
+    ensureExact();
+    return m_obstacleBallsZ;
+}
+
+const Triangle_list_3_Z &SceneSnapshot::movableTrianglesZ() const
+{
+    ensureExact();
+    return m_movableTrianglesZ;
+}
+
+const Triangle_list_3_Z &SceneSnapshot::obstacleTrianglesZ() const
+{
+    ensureExact();
+    return m_obstacleTrianglesZ;
+}
+
+bool SceneSnapshot::isExactTruncated() const
+{
+    ensureExact();
+    return m_exactTruncated;
+}
+
+void SceneSnapshot::prune(const SceneObjects &sceneObjects)
+{
+    pruneBallsHierarchically(sceneObjects);
+    pruneTriangles(sceneObjects);
+}
+
+void SceneSnapshot::pruneBallsHierarchically(const SceneObjects &sceneObjects)
+{
+    if (m_movableBalls.empty() || m_obstacleBalls.empty())
+        return;
+
+    // one shell tree per object, sphere trees keep their own hierarchy
+    RadialShellTreeList movableTrees;
+    RadialShellTreeList obstacleTrees;
+
+    size_t movableOffset = 0;
+    size_t obstacleOffset = 0;
+
+    for (SceneObjects::const_iterator sceneObjectIterator = sceneObjects.begin();
+         sceneObjectIterator != sceneObjects.end(); ++sceneObjectIterator)
+    {
+        bool movable = (*sceneObjectIterator)->isRotating();
+        size_t &offset = movable ? movableOffset : obstacleOffset;
+        RadialShellTreeList &trees = movable ? movableTrees : obstacleTrees;
+
+        DecimalBallListPtr ballList = (*sceneObjectIterator)->decimalBallList();
+        DecimalBallTreePtr ballTree = (*sceneObjectIterator)->decimalBallTree();
+        DoubleGeometryPtr geometry = (*sceneObjectIterator)->doubleGeometry();
+
+        if (ballTree)
+        {
+            trees.push_back(RadialShellTree(*ballTree, *geometry, offset));
+        }
+        else
+        {
+            RadialShellList shells;
+            shells.reserve(ballList->size());
+
+            for (size_t i = 0; i < ballList->size(); ++i)
+                shells.push_back(radialShell(*geometry, i));
+
+            trees.push_back(RadialShellTree(shells, offset));
+        }
+
+        offset += ballList->size();
+    }
+
+    std::vector<bool> movableKept(m_movableBalls.size(), false);
+    std::vector<bool> obstaclesKept(m_obstacleBalls.size(), false);
+
+    unsigned long long pairs = static_cast<unsigned long long>(m_movableBalls.size()) * m_obstacleBalls.size();
+    unsigned long long overlappingPairs = radialPrune(movableTrees, obstacleTrees, movableKept, obstaclesKept);
+
+    applyPruning(m_movableBalls, m_obstacleBalls, m_movableBallsR, m_obstacleBallsR, movableKept, obstaclesKept, pairs, overlappingPairs);
+}
+
+void SceneSnapshot::pruneTriangles(const SceneObjects &sceneObjects)
+{
+    if (m_movableTriangles.empty() || m_obstacleTriangles.empty())
+        return;
+
+    // objects are visited in the order their triangles were added
+    RadialShellList movableShells;
+    RadialShellList obstacleShells;
+
+    for (SceneObjects::const_iterator sceneObjectIterator = sceneObjects.begin();
+         sceneObjectIterator != sceneObjects.end(); ++sceneObjectIterator)
+    {
+        RadialShellList &shells = (*sceneObjectIterator)->isRotating() ? movableShells : obstacleShells;
+
+        DecimalTriangleListPtr triangleList = (*sceneObjectIterator)->decimalTriangleList();
+        DoubleGeometryPtr geometry = (*sceneObjectIterator)->doubleGeometry();
+
+        for (size_t i = 0; i < triangleList->size(); ++i)
+            shells.push_back(radialShell(*geometry, triangleList->face(i)));
+    }
+
+    pruneRadially(m_movableTriangles, m_obstacleTriangles, m_movableTrianglesR, m_obstacleTrianglesR, movableShells, obstacleShells);
+}
+
+void SceneSnapshot::ensureExact() const
+{
+    // the exact part is written once, then only read
+    QMutexLocker locker(&m_exactMutex);
+
+    if (m_exactReady)
+        return;
+
+    // convert with the smallest common scale
+    ExactSceneConverter converter;
+
+    addToConverter(m_movableBalls, converter);
+    addToConverter(m_obstacleBalls, converter);
+    addToConverter(m_movableTriangles, converter);
+    addToConverter(m_obstacleTriangles, converter);
+
+    converter.convert();
+
+    m_exactTruncated = converter.isTruncated();
+
+    size_t index = 0;
+
+    appendZ(m_movableBalls, converter, index, m_movableBallsZ);
+    appendZ(m_obstacleBalls, converter, index, m_obstacleBallsZ);
+    appendZ(m_movableTriangles, converter, index, m_movableTrianglesZ);
+    appendZ(m_obstacleTriangles, converter, index, m_obstacleTrianglesZ);
+
+    assert(index == converter.numberOfValues());
+
+    LOG4CXX_INFO(g_logger, "Exact scene: " << converter.numberOfValues() << " coordinates"
+                 << ", scale 2^" << converter.powerOfTwo() << " * 5^" << converter.powerOfFive()
+                 << ", reduced by gcd " << converter.gcd()
+                 << ", maximum bit length " << converter.maximumBitLength());
+
+    m_exactReady = true;
+}
+
+void SceneSnapshot::computeHash()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(m_type == SceneObject::Type_DecimalBallList ? "balls\n" : "triangles\n");
+
+    addToHash("movable balls ", m_movableBalls, hash);
+    addToHash("obstacle balls ", m_obstacleBalls, hash);
+    addToHash("movable triangles ", m_movableTriangles, hash);
+    addToHash("obstacle triangles ", m_obstacleTriangles, hash);
+
+    m_hash = hash.result().toHex().constData();
+}
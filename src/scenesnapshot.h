@@ -0,0 +1,123 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#include "kernel.h"
+#include "sceneobject.h"
+#include <QMutex>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <vector>
+
+class SceneSnapshot;
+typedef boost::shared_ptr<const SceneSnapshot> SceneSnapshotPtr;
+
+// an immutable copy of the scene split into movable and obstacle parts
+//
+// inexact geometry over R is converted once at construction; exact
+// geometry over Z is converted on first use and kept afterwards,
+// so a snapshot can be shared by any number of concurrent builders
+//
+// primitives which can never collide with any primitive of the other
+// set under rotation about the origin are left out of the geometry
+class SceneSnapshot
+    : private boost::noncopyable
+{
+public:
+    // all objects must be of the given type
+    SceneSnapshot(const std::vector<SceneObjectPtr> &sceneObjects, SceneObject::Type type, unsigned int version);
+
+    SceneObject::Type           type() const;
+    unsigned int                version() const;
+
+    // hex SHA-1 of the geometry which reaches the builders, equal for
+    // identical scenes
+    const std::string &         hash() const;
+
+    // counts before pruning
+    size_t                      numberOfMovable() const;
+    size_t                      numberOfObstacles() const;
+
+    // inexact geometry
+    const Ball_list_3_R &       movableBallsR() const;
+    const Ball_list_3_R &       obstacleBallsR() const;
+
+    const Triangle_list_3_R &   movableTrianglesR() const;
+    const Triangle_list_3_R &   obstacleTrianglesR() const;
+
+    // exact geometry, scaled to the smallest common integers
+    const Ball_list_3_Z &       movableBallsZ() const;
+    const Ball_list_3_Z &       obstacleBallsZ() const;
+
+    const Triangle_list_3_Z &   movableTrianglesZ() const;
+    const Triangle_list_3_Z &   obstacleTrianglesZ() const;
+
+    // true if some coordinates had to be truncated for the exact geometry
+    bool                        isExactTruncated() const;
+
+private:
+    typedef std::vector<SceneObjectPtr>             SceneObjects;
+    typedef std::vector<const DecimalBall *>        DecimalBallRefList;
+    typedef std::vector<const DecimalTriangle *>    DecimalTriangleRefList;
+
+    // keep referenced primitives alive, even if an object later
+    // replaces its lists
+    std::vector<DecimalBallListPtr>     m_ballLists;
+    std::vector<DecimalTriangleListPtr> m_triangleLists;
+
+    SceneObject::Type           m_type;
+    unsigned int                m_version;
+
+    std::string                 m_hash;
+
+    size_t                      m_numberOfMovable;
+    size_t                      m_numberOfObstacles;
+
+    // split at construction, later rotation changes do not affect the snapshot
+    DecimalBallRefList          m_movableBalls;
+    DecimalBallRefList          m_obstacleBalls;
+    DecimalTriangleRefList      m_movableTriangles;
+    DecimalTriangleRefList      m_obstacleTriangles;
+
+    Ball_list_3_R               m_movableBallsR;
+    Ball_list_3_R               m_obstacleBallsR;
+    Triangle_list_3_R           m_movableTrianglesR;
+    Triangle_list_3_R           m_obstacleTrianglesR;
+
+    // lazy exact part
+    mutable QMutex              m_exactMutex;
+    mutable bool                m_exactReady;
+    mutable bool                m_exactTruncated;
+
+    mutable Ball_list_3_Z       m_movableBallsZ;
+    mutable Ball_list_3_Z       m_obstacleBallsZ;
+    mutable Triangle_list_3_Z   m_movableTrianglesZ;
+    mutable Triangle_list_3_Z   m_obstacleTrianglesZ;
+
+    void                        prune(const SceneObjects &sceneObjects);
+    void                        pruneBallsHierarchically(const SceneObjects &sceneObjects);
+    void                        pruneTriangles(const SceneObjects &sceneObjects);
+    void                        computeHash();
+    void                        ensureExact() const;
+};
+
+#endif // SCENESNAPSHOT_H
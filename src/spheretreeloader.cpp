@@ -18,8 +18,42 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "spheretreeloader.h"
-#include <sstream>
-#include <fstream>
+#include "texttokenizer.h"
+#include <QFile>
+#include <algorithm>
+
+namespace // anonymous
+{
+// every node takes one line of x y z r and a fifth value; shorter lines are empty slots
+const int FIELDS_PER_NODE = 5;
+
+// nodes read between progress updates
+const size_t PROGRESS_INTERVAL = 4096;
+
+// split the line at current into at most the given number of tokens,
+// returns the number found and moves current past the line
+int splitLine(const char *&current, const char *end, const char **begins, const char **ends, int maximum)
+{
+    const char *lineEnd = std::find(current, end, '\n');
+    const char *tokenBegin, *tokenEnd;
+    int count = 0;
+
+    while (nextToken(current, lineEnd, tokenBegin, tokenEnd))
+    {
+        if (count < maximum)
+        {
+            begins[count] = tokenBegin;
+            ends[count] = tokenEnd;
+        }
+
+        ++count;
+    }
+
+    current = (lineEnd == end) ? end : lineEnd + 1;
+
+    return count < maximum ? count : maximum;
+}
+} // namespace anonymous
 
 SphereTreeLoader::SphereTreeLoader()
     : m_numberOfLevels(0),
@@ -27,25 +61,30 @@ SphereTreeLoader::SphereTreeLoader()
 {
 }
 
-bool SphereTreeLoader::loadFromFile(const char *fileName, bool normalize)
+bool SphereTreeLoader::loadFromFile(const char *fileName, bool normalize, ImportProgress *progress)
 {
-    std::ifstream file(fileName);
+    QFile file(QString::fromLocal8Bit(fileName));
 
-    if (!file.is_open())
+    if (!file.open(QFile::ReadOnly) || !file.size())
         return false;
 
-    std::string line;
+    // the mapping lives as long as the file object
+    const char *current = reinterpret_cast<const char *>(file.map(0, file.size()));
 
-    if (!std::getline(file, line))
+    if (!current)
         return false;
 
-    int numberOfLevels, levelDegree;
+    const char *begin = current;
+    const char *end = current + file.size();
 
-    std::istringstream header(line);
+    const char *begins[FIELDS_PER_NODE];
+    const char *ends[FIELDS_PER_NODE];
 
-    header >> numberOfLevels >> levelDegree;
+    int numberOfLevels, levelDegree;
 
-    if (!header)
+    if (splitLine(current, end, begins, ends, 2) != 2 ||
+        !parseInt(begins[0], ends[0], numberOfLevels) ||
+        !parseInt(begins[1], ends[1], levelDegree))
         return false;
 
     if (numberOfLevels <= 0 || levelDegree <= 0)
@@ -54,58 +93,95 @@ bool SphereTreeLoader::loadFromFile(const char *fileName, bool normalize)
     m_numberOfLevels = static_cast<size_t>(numberOfLevels);
     m_levelDegree = static_cast<size_t>(levelDegree);
 
-    int numberOfNodes = 1;
+    m_balls.clear();
+    m_parents.clear();
+    m_firstChildren.clear();
+    m_numbersOfChildren.clear();
+    m_levelOffsets.assign(1, 0);
+
+    size_t numberOfNodes = 1;
     QDecimal maxAbsoluteCoordinate = 0;
 
-    for (int k = 0; k < numberOfLevels; k++)
+    // ball in a slot of the previous level, -1 for empty slots
+    std::vector<int> previousSlots;
+    std::vector<int> slots;
+
+    for (size_t k = 0; k < m_numberOfLevels; k++)
     {
-        Level level;
+        slots.assign(numberOfNodes, -1);
 
-        for (int i = 0; i < numberOfNodes; i++)
+        for (size_t i = 0; i < numberOfNodes; i++)
         {
-            if (!std::getline(file, line))
+            if (current == end)
                 return false;
 
-            //  read the sphere
-            std::string x, y, z, r, dummy;
-            std::istringstream parser(line);
+            // progress follows the position in the file
+            if (progress && !(i % PROGRESS_INTERVAL))
+            {
+                if (progress->isCancelled())
+                    return false;
 
-            parser >> x >> y >> z >> r >> dummy;
+                progress->setValue(static_cast<int>(ImportProgress::MAXIMUM * (current - begin) / (end - begin)));
+            }
 
-            if (parser)
-            {
-                QDecimal decimalX(x.c_str());
-                QDecimal decimalY(y.c_str());
-                QDecimal decimalZ(z.c_str());
-                QDecimal decimalR(r.c_str());
+            // read the sphere
+            if (splitLine(current, end, begins, ends, FIELDS_PER_NODE) != FIELDS_PER_NODE)
+                continue;
+
+            QDecimal x, y, z, r;
+
+            parseDecimal(begins[0], ends[0], x);
+            parseDecimal(begins[1], ends[1], y);
+            parseDecimal(begins[2], ends[2], z);
+            parseDecimal(begins[3], ends[3], r);
 
-                level.push_back(DecimalBall(DecimalVector(decimalX, decimalY, decimalZ), decimalR));
+            int index = static_cast<int>(m_balls.size());
+            int parent = k ? previousSlots[i / m_levelDegree] : -1;
 
-                QDecimal absoluteDecimalX(decimalX.abs());
-                QDecimal absoluteDecimalY(decimalY.abs());
-                QDecimal absoluteDecimalZ(decimalZ.abs());
+            slots[i] = index;
 
-                if (absoluteDecimalX > maxAbsoluteCoordinate) maxAbsoluteCoordinate = absoluteDecimalX;
-                if (absoluteDecimalY > maxAbsoluteCoordinate) maxAbsoluteCoordinate = absoluteDecimalY;
-                if (absoluteDecimalZ > maxAbsoluteCoordinate) maxAbsoluteCoordinate = absoluteDecimalZ;
+            m_balls.push_back(DecimalBall(DecimalVector(x, y, z), r));
+            m_parents.push_back(parent);
+            m_firstChildren.push_back(-1);
+            m_numbersOfChildren.push_back(0);
+
+            // siblings follow each other, so children are contiguous
+            if (parent != -1)
+            {
+                if (!m_numbersOfChildren[static_cast<size_t>(parent)]++)
+                    m_firstChildren[static_cast<size_t>(parent)] = index;
             }
+
+            QDecimal absoluteX(x.abs());
+            QDecimal absoluteY(y.abs());
+            QDecimal absoluteZ(z.abs());
+
+            if (absoluteX > maxAbsoluteCoordinate) maxAbsoluteCoordinate = absoluteX;
+            if (absoluteY > maxAbsoluteCoordinate) maxAbsoluteCoordinate = absoluteY;
+            if (absoluteZ > maxAbsoluteCoordinate) maxAbsoluteCoordinate = absoluteZ;
         }
 
-        // accumulate level
-        m_levels.push_back(level);
+        m_levelOffsets.push_back(m_balls.size());
+        previousSlots.swap(slots);
+
+        // next degree; every node takes at least one line, so a level
+        // with more nodes than bytes left is a damaged file
+        if (k + 1 < m_numberOfLevels)
+        {
+            if (numberOfNodes > static_cast<size_t>(end - current) / m_levelDegree)
+                return false;
 
-        // next degree
-        numberOfNodes *= levelDegree;
+            numberOfNodes *= m_levelDegree;
+        }
     }
 
-    // normalize if needed
+    // normalize if needed, one pass over all levels
     if (normalize)
     {
         QDecimal scale = QDecimal(1) / maxAbsoluteCoordinate;
 
-        for (typename Levels::iterator level_iterator = m_levels.begin(); level_iterator != m_levels.end(); ++level_iterator)
-            for (typename Level::iterator ball_iterator = level_iterator->begin(); ball_iterator != level_iterator->end(); ++ball_iterator)
-                ball_iterator->scale(scale);
+        for (DecimalBallList::iterator it = m_balls.begin(); it != m_balls.end(); ++it)
+            it->scale(scale);
     }
 
     return true;
@@ -121,17 +197,56 @@ size_t SphereTreeLoader::levelDegree() const
     return m_levelDegree;
 }
 
-typename SphereTreeLoader::const_iterator SphereTreeLoader::level_begin(size_t level) const
+SphereTreeLoader::const_iterator SphereTreeLoader::level_begin(size_t level) const
+{
+    return m_balls.begin() + static_cast<std::ptrdiff_t>(m_levelOffsets[level]);
+}
+
+SphereTreeLoader::const_iterator SphereTreeLoader::level_end(size_t level) const
+{
+    return m_balls.begin() + static_cast<std::ptrdiff_t>(m_levelOffsets[level + 1]);
+}
+
+size_t SphereTreeLoader::levelSize(size_t level) const
+{
+    return m_levelOffsets[level + 1] - m_levelOffsets[level];
+}
+
+const DecimalBallList &SphereTreeLoader::balls() const
+{
+    return m_balls;
+}
+
+int SphereTreeLoader::parent(size_t ball) const
+{
+    return m_parents[ball];
+}
+
+int SphereTreeLoader::firstChild(size_t ball) const
 {
-    return m_levels[level].begin();
+    return m_firstChildren[ball];
 }
 
-typename SphereTreeLoader::const_iterator SphereTreeLoader::level_end(size_t level) const
+size_t SphereTreeLoader::numberOfChildren(size_t ball) const
 {
-    return m_levels[level].end();
+    return static_cast<size_t>(m_numbersOfChildren[ball]);
 }
 
-DecimalBallList SphereTreeLoader::level(size_t level) const
+DecimalBallListPtr SphereTreeLoader::level(size_t level) const
 {
-    return m_levels[level];
+    return DecimalBallListPtr(new DecimalBallList(level_begin(level), level_end(level)));
+}
+
+DecimalBallTreePtr SphereTreeLoader::tree(size_t leafLevel) const
+{
+    DecimalBallTreePtr tree(new DecimalBallTree());
+
+    // levels are stored in order, so node indices match ball indices
+    size_t leafOffset = m_levelOffsets[leafLevel];
+    size_t end = m_levelOffsets[leafLevel + 1];
+
+    for (size_t i = 0; i < end; ++i)
+        tree->addNode(m_balls[i], m_parents[i], i >= leafOffset ? static_cast<int>(i - leafOffset) : DecimalBallTree::NO_NODE);
+
+    return tree;
 }
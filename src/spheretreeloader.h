@@ -21,33 +21,54 @@
 #define SPHERETREELOADER_H
 
 #include "decimalscene.h"
+#include "importprogress.h"
+#include <boost/noncopyable.hpp>
 #include <vector>
 #include <cstddef>
 
+// all levels of a sphere tree in flat arrays; balls are stored level by
+// level, links are indices into balls() or -1
 class SphereTreeLoader
+    : private boost::noncopyable
 {
-    typedef DecimalBallList                 Level;
-    typedef std::vector<Level>              Levels;
-
 public:
-    typedef typename Level::const_iterator  const_iterator;
+    typedef DecimalBallList::const_iterator const_iterator;
 
     SphereTreeLoader();
 
-    bool            loadFromFile(const char *fileName, bool normalize = true);
+    // progress is optional; fails when cancelled
+    bool            loadFromFile(const char *fileName, bool normalize = true, ImportProgress *progress = 0);
 
     size_t          numberOfLevels() const;
     size_t          levelDegree() const;
 
     const_iterator  level_begin(size_t level) const;
     const_iterator  level_end(size_t level) const;
+    size_t          levelSize(size_t level) const;
+
+    const DecimalBallList &balls() const;
+
+    int             parent(size_t ball) const;
+    int             firstChild(size_t ball) const;
+    size_t          numberOfChildren(size_t ball) const;
 
-    DecimalBallList level(size_t level) const;
+    // copy of a single level
+    DecimalBallListPtr  level(size_t level) const;
+
+    // hierarchy down to the given level, leaves index level(leafLevel)
+    DecimalBallTreePtr  tree(size_t leafLevel) const;
 
 private:
-    size_t          m_numberOfLevels;
-    size_t          m_levelDegree;
-    Levels          m_levels;
+    size_t              m_numberOfLevels;
+    size_t              m_levelDegree;
+
+    DecimalBallList     m_balls;
+    std::vector<int>    m_parents;
+    std::vector<int>    m_firstChildren;
+    std::vector<int>    m_numbersOfChildren;
+
+    // first ball of every level, and the end of the last one
+    std::vector<size_t> m_levelOffsets;
 };
 
 #endif // SPHERETREELOADER_H
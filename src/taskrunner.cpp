@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "taskrunner.h"
+#include <QRunnable>
+#include <QTimer>
+#include <log4cxx/logger.h>
+#include <algorithm>
+#include <exception>
+
+namespace // anonymous
+{
+log4cxx::LoggerPtr g_logger(log4cxx::Logger::getLogger("arrangement.taskrunner"));
+
+// progress is polled rather than signalled by the workers
+const int PROGRESS_INTERVAL = 100;
+} // namespace anonymous
+
+class TaskRunner::Job
+    : public QRunnable
+{
+public:
+    Job(TaskRunner *runner, const Task &task, ImportProgressPtr progress)
+        : m_runner(runner),
+          m_task(task),
+          m_progress(progress)
+    {
+    }
+
+    virtual void run()
+    {
+        bool succeeded = false;
+
+        try
+        {
+            succeeded = m_task(*m_progress);
+        }
+        catch (const std::exception &exception)
+        {
+            LOG4CXX_ERROR(g_logger, "Task failed: " << exception.what());
+        }
+        catch (...)
+        {
+            LOG4CXX_ERROR(g_logger, "Task failed: unknown error");
+        }
+
+        if (!succeeded)
+            m_runner->m_failed.store(1);
+
+        m_progress->setValue(ImportProgress::MAXIMUM);
+
+        QMetaObject::invokeMethod(m_runner, "taskDone", Qt::QueuedConnection);
+    }
+
+private:
+    TaskRunner *        m_runner;
+    Task                m_task;
+    ImportProgressPtr   m_progress;
+};
+
+TaskRunner::TaskRunner(QObject *parent)
+    : QObject(parent),
+      m_pending(0),
+      m_failed(0),
+      m_timer(new QTimer(this))
+{
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(updateProgress()));
+}
+
+TaskRunner::~TaskRunner()
+{
+    // workers report into this object
+    cancel();
+    m_pool.waitForDone();
+}
+
+bool TaskRunner::start(const std::vector<Task> &tasks, const Finish &finish)
+{
+    if (isRunning() || tasks.empty())
+        return false;
+
+    m_progress.clear();
+    m_pending = tasks.size();
+    m_finish = finish;
+    m_failed.store(0);
+
+    m_elapsed.start();
+    m_timer->start(PROGRESS_INTERVAL);
+
+    // one worker for every task
+    m_pool.setMaxThreadCount(std::max(m_pool.maxThreadCount(), static_cast<int>(tasks.size())));
+
+    for (std::vector<Task>::const_iterator it = tasks.begin(); it != tasks.end(); ++it)
+    {
+        m_progress.push_back(ImportProgressPtr(new ImportProgress()));
+        m_pool.start(new Job(this, *it, m_progress.back()));
+    }
+
+    emit progressChanged(0);
+    return true;
+}
+
+bool TaskRunner::isRunning() const
+{
+    return m_pending != 0;
+}
+
+void TaskRunner::cancel()
+{
+    for (std::vector<ImportProgressPtr>::const_iterator it = m_progress.begin(); it != m_progress.end(); ++it)
+        (*it)->cancel();
+}
+
+void TaskRunner::updateProgress()
+{
+    if (m_progress.empty())
+        return;
+
+    int total = 0;
+
+    for (std::vector<ImportProgressPtr>::const_iterator it = m_progress.begin(); it != m_progress.end(); ++it)
+        total += (*it)->value();
+
+    emit progressChanged(total / static_cast<int>(m_progress.size()));
+}
+
+void TaskRunner::taskDone()
+{
+    if (!m_pending || --m_pending)
+        return;
+
+    m_timer->stop();
+
+    bool cancelled = !m_progress.empty() && m_progress.front()->isCancelled();
+    bool succeeded = !cancelled && !m_failed.load();
+
+    Finish finish;
+    finish.swap(m_finish);
+
+    if (succeeded)
+        LOG4CXX_INFO(g_logger, "Tasks: " << m_progress.size() << " done in " << m_elapsed.elapsed() << " ms");
+    else if (cancelled)
+        LOG4CXX_INFO(g_logger, "Tasks cancelled");
+
+    // the finish function may ask further questions, so the progress is closed first
+    emit finished(succeeded, cancelled);
+
+    if (succeeded)
+        finish();
+}
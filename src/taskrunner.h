@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TASKRUNNER_H
+#define TASKRUNNER_H
+
+#include "importprogress.h"
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+class QTimer;
+
+// runs long tasks such as scene imports on a background pool, so they do
+// not block the GUI
+//
+// every task of a run has its own worker, so the files of one import load
+// concurrently; the finish function runs on the GUI thread once all tasks
+// succeeded and is dropped if any of them failed or the run was cancelled
+class TaskRunner
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    // runs on a worker thread and must not touch widgets;
+    // returns false on failure
+    typedef boost::function<bool (ImportProgress &progress)> Task;
+    typedef boost::function<void ()> Finish;
+
+    explicit TaskRunner(QObject *parent = 0);
+    ~TaskRunner();
+
+    // returns false if the previous run is still going
+    bool                start(const std::vector<Task> &tasks, const Finish &finish);
+    bool                isRunning() const;
+
+public slots:
+    void                cancel();
+
+signals:
+    // average progress of all tasks, 0 to ImportProgress::MAXIMUM
+    void                progressChanged(int value);
+
+    // before the finish function, or instead of it
+    void                finished(bool succeeded, bool cancelled);
+
+private slots:
+    void                updateProgress();
+    void                taskDone();
+
+private:
+    class Job;
+
+    typedef boost::shared_ptr<ImportProgress> ImportProgressPtr;
+
+    std::vector<ImportProgressPtr>  m_progress;
+    size_t                          m_pending;
+    Finish                          m_finish;
+
+    // set by the workers
+    QAtomicInt                      m_failed;
+
+    QTimer *                        m_timer;
+    QElapsedTimer                   m_elapsed;
+    QThreadPool                     m_pool;
+};
+
+#endif // TASKRUNNER_H
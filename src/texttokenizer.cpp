@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "texttokenizer.h"
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace // anonymous
+{
+// longer decimals are parsed through the heap
+const size_t TOKEN_BUFFER_SIZE = 128;
+} // namespace anonymous
+
+bool nextToken(const char *&current, const char *lineEnd, const char *&tokenBegin, const char *&tokenEnd)
+{
+    while (current != lineEnd && isBlank(*current))
+        ++current;
+
+    if (current == lineEnd)
+        return false;
+
+    tokenBegin = current;
+
+    while (current != lineEnd && !isBlank(*current))
+        ++current;
+
+    tokenEnd = current;
+    return true;
+}
+
+bool parseSize(const char *begin, const char *end, size_t &value)
+{
+    value = 0;
+
+    if (begin == end)
+        return false;
+
+    for (const char *current = begin; current != end; ++current)
+    {
+        if (*current < '0' || *current > '9')
+            return false;
+
+        size_t digit = static_cast<size_t>(*current - '0');
+
+        if (value > (std::numeric_limits<size_t>::max() - digit) / 10)
+            return false;
+
+        value = value * 10 + digit;
+    }
+
+    return true;
+}
+
+bool parseInt(const char *begin, const char *end, int &value)
+{
+    bool negative = (begin != end && *begin == '-');
+
+    if (negative || (begin != end && *begin == '+'))
+        ++begin;
+
+    size_t magnitude;
+
+    if (!parseSize(begin, end, magnitude))
+        return false;
+
+    // the magnitude of the smallest int is one more than the largest
+    size_t limit = static_cast<size_t>(std::numeric_limits<int>::max()) + (negative ? 1 : 0);
+
+    if (magnitude > limit)
+        return false;
+
+    value = negative ? static_cast<int>(-static_cast<long long>(magnitude)) : static_cast<int>(magnitude);
+    return true;
+}
+
+void parseDecimal(const char *begin, const char *end, QDecimal &value)
+{
+    size_t length = static_cast<size_t>(end - begin);
+
+    // the decimal parser needs a terminated string
+    if (length < TOKEN_BUFFER_SIZE)
+    {
+        char buffer[TOKEN_BUFFER_SIZE];
+        std::memcpy(buffer, begin, length);
+        buffer[length] = 0;
+
+        value.fromString(buffer);
+    }
+    else
+    {
+        value.fromString(std::string(begin, end).c_str());
+    }
+}
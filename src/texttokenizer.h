@@ -0,0 +1,67 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef TEXTTOKENIZER_H
+#define TEXTTOKENIZER_H
+
+#include "qdecimal.h"
+#include <cstddef>
+
+// tokens of a mapped text file, given as a begin and end pointer;
+// nothing is copied and the parsers fail instead of wrapping around
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+}
+
+// white space which does not end a line
+inline bool isBlank(char c)
+{
+    return c != '\n' && isSpace(c);
+}
+
+inline const char *skipSpace(const char *current, const char *end)
+{
+    while (current != end && isSpace(*current))
+        ++current;
+
+    return current;
+}
+
+inline const char *skipToken(const char *current, const char *end)
+{
+    while (current != end && !isSpace(*current))
+        ++current;
+
+    return current;
+}
+
+// next token of the line, false at its end
+bool nextToken(const char *&current, const char *lineEnd, const char *&tokenBegin, const char *&tokenEnd);
+
+// decimal digits only; false on anything else and on overflow
+bool parseSize(const char *begin, const char *end, size_t &value);
+
+// optional sign and decimal digits; false on anything else and on overflow
+bool parseInt(const char *begin, const char *end, int &value);
+
+void parseDecimal(const char *begin, const char *end, QDecimal &value);
+
+#endif // TEXTTOKENIZER_H
@@ -94,12 +94,12 @@ void TriangleIntersectionDialog::on_pushButtonRandom_clicked()
     long bx = 0, by = 0, bz = 0;
     long cx = 0, cy = 0, cz = 0;
 
-    k.x().longify(kx); k.y().longify(ky); k.z().longify(kz);
-    l.x().longify(lx); l.y().longify(ly); l.z().longify(lz);
-    m.x().longify(mx); m.y().longify(my); m.z().longify(mz);
-    a.x().longify(ax); a.y().longify(ay); a.z().longify(az);
-    b.x().longify(bx); b.y().longify(by); b.z().longify(bz);
-    c.x().longify(cx); c.y().longify(cy); c.z().longify(cz);
+    kx = zToLong(k.x()); ky = zToLong(k.y()); kz = zToLong(k.z());
+    lx = zToLong(l.x()); ly = zToLong(l.y()); lz = zToLong(l.z());
+    mx = zToLong(m.x()); my = zToLong(m.y()); mz = zToLong(m.z());
+    ax = zToLong(a.x()); ay = zToLong(a.y()); az = zToLong(a.z());
+    bx = zToLong(b.x()); by = zToLong(b.y()); bz = zToLong(b.z());
+    cx = zToLong(c.x()); cy = zToLong(c.y()); cz = zToLong(c.z());
 
     ui->lineEditK->setText(QString("%1; %2; %3").arg(kx).arg(ky).arg(kz));
     ui->lineEditL->setText(QString("%1; %2; %3").arg(lx).arg(ly).arg(lz));
@@ -20,15 +20,17 @@
 #include "trianglelistmesh.h"
 #include <QVector3D>
 #include <GL/gl.h>
+#include <vector>
 
 // settings
 #define DRAW_NORMALS    0
 #define DRAW_OUTLINES   0
 #define FLAT_SHADING    1
 
-TriangleListMesh::TriangleListMesh(QGLWidget *gl, DecimalTriangleListPtr decimalTriangleList)
+TriangleListMesh::TriangleListMesh(QGLWidget *gl, DecimalTriangleListPtr decimalTriangleList, DoubleGeometryPtr doubleGeometry)
     : Mesh(gl),
-      m_decimalTriangleList(decimalTriangleList)
+      m_decimalTriangleList(decimalTriangleList),
+      m_doubleGeometry(doubleGeometry)
 {
 }
 
@@ -49,16 +51,23 @@ void TriangleListMesh::drawMesh()
 
 void TriangleListMesh::drawDecimalTriangleList()
 {
+    // shared vertices come from the double geometry
+    std::vector<QVector3D> points;
+    points.reserve(m_doubleGeometry->numberOfPoints());
+
+    for (size_t i = 0; i < m_doubleGeometry->numberOfPoints(); ++i)
+        points.push_back(QVector3D(m_doubleGeometry->x()[i], m_doubleGeometry->y()[i], m_doubleGeometry->z()[i]));
+
     // draw faces
     glBegin(GL_TRIANGLES);
 
-    for (DecimalTriangleList::const_iterator iterator = m_decimalTriangleList->begin(); iterator != m_decimalTriangleList->end(); ++iterator)
+    for (size_t i = 0; i < m_decimalTriangleList->size(); ++i)
     {
-        const DecimalTriangle &triangle = *iterator;
+        DecimalFace face = m_decimalTriangleList->face(i);
 
-        QVector3D vertex_a(triangle.vertex(0).x().toDouble(), triangle.vertex(0).y().toDouble(), triangle.vertex(0).z().toDouble());
-        QVector3D vertex_b(triangle.vertex(1).x().toDouble(), triangle.vertex(1).y().toDouble(), triangle.vertex(1).z().toDouble());
-        QVector3D vertex_c(triangle.vertex(2).x().toDouble(), triangle.vertex(2).y().toDouble(), triangle.vertex(2).z().toDouble());
+        const QVector3D &vertex_a = points[face.vertex(0)];
+        const QVector3D &vertex_b = points[face.vertex(1)];
+        const QVector3D &vertex_c = points[face.vertex(2)];
 
 #if FLAT_SHADING
 
@@ -102,13 +111,13 @@ void TriangleListMesh::drawDecimalTriangleList()
 
     glBegin(GL_LINES);
 
-    for (DecimalTriangleList::const_iterator iterator = m_decimalTriangleList->begin(); iterator != m_decimalTriangleList->end(); ++iterator)
+    for (size_t i = 0; i < m_decimalTriangleList->size(); ++i)
     {
-        const DecimalTriangle &triangle = *iterator;
+        DecimalFace face = m_decimalTriangleList->face(i);
 
-        QVector3D vertex_a(triangle.vertex(0).x().toDouble(), triangle.vertex(0).y().toDouble(), triangle.vertex(0).z().toDouble());
-        QVector3D vertex_b(triangle.vertex(1).x().toDouble(), triangle.vertex(1).y().toDouble(), triangle.vertex(1).z().toDouble());
-        QVector3D vertex_c(triangle.vertex(2).x().toDouble(), triangle.vertex(2).y().toDouble(), triangle.vertex(2).z().toDouble());
+        const QVector3D &vertex_a = points[face.vertex(0)];
+        const QVector3D &vertex_b = points[face.vertex(1)];
+        const QVector3D &vertex_c = points[face.vertex(2)];
 
         QVector3D plane_normal = QVector3D::crossProduct(vertex_b - vertex_a, vertex_c - vertex_a);
         plane_normal /= plane_normal.length();
@@ -136,17 +145,17 @@ void TriangleListMesh::drawDecimalTriangleList()
 
     glBegin(GL_LINES);
 
-    for (DecimalTriangleList::const_iterator iterator = m_decimalTriangleList->begin(); iterator != m_decimalTriangleList->end(); ++iterator)
+    for (size_t i = 0; i < m_decimalTriangleList->size(); ++i)
     {
-        const DecimalTriangle &triangle = *iterator;
+        DecimalFace face = m_decimalTriangleList->face(i);
 
-        QVector3D vertex_a(triangle.vertex(0).x().toDouble(), triangle.vertex(0).y().toDouble(), triangle.vertex(0).z().toDouble());
-        QVector3D vertex_b(triangle.vertex(1).x().toDouble(), triangle.vertex(1).y().toDouble(), triangle.vertex(1).z().toDouble());
-        QVector3D vertex_c(triangle.vertex(2).x().toDouble(), triangle.vertex(2).y().toDouble(), triangle.vertex(2).z().toDouble());
+        const QVector3D &vertex_a = points[face.vertex(0)];
+        const QVector3D &vertex_b = points[face.vertex(1)];
+        const QVector3D &vertex_c = points[face.vertex(2)];
 
-        QVector3D normal_a(triangle.normal().x().toDouble(), triangle.normal().y().toDouble(), triangle.normal().z().toDouble());
-        QVector3D normal_b(triangle.normal().x().toDouble(), triangle.normal().y().toDouble(), triangle.normal().z().toDouble());
-        QVector3D normal_c(triangle.normal().x().toDouble(), triangle.normal().y().toDouble(), triangle.normal().z().toDouble());
+        QVector3D normal_a = QVector3D::crossProduct(vertex_b - vertex_a, vertex_c - vertex_a);
+        QVector3D normal_b = normal_a;
+        QVector3D normal_c = normal_a;
 
         normal_a /= normal_a.length();
         normal_b /= normal_b.length();
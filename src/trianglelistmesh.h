@@ -22,6 +22,7 @@
 
 #include "mesh.h"
 #include "decimalscene.h"
+#include "doublegeometry.h"
 #include "variantpredicate.h"
 #include <boost/shared_ptr.hpp>
 
@@ -30,13 +31,15 @@ class TriangleListMesh
 {
 public:
     TriangleListMesh(QGLWidget *gl,
-                     DecimalTriangleListPtr decimalTriangleList);
+                     DecimalTriangleListPtr decimalTriangleList,
+                     DoubleGeometryPtr doubleGeometry);
 
     TriangleListMesh(QGLWidget *gl,
                      Mesh_smooth_triangle_list_3_Z_ptr smoothTriangleList);
 
 private:
     DecimalTriangleListPtr              m_decimalTriangleList;
+    DoubleGeometryPtr                   m_doubleGeometry;
     Mesh_smooth_triangle_list_3_Z_ptr   m_smoothTriangleList;
 
     void                                drawDecimalTriangleList();
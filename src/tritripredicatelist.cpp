@@ -18,6 +18,28 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "tritripredicatelist.h"
+#include <algorithm>
+
+namespace // anonymous
+{
+// true if triangle abc rotated about the origin never reaches the plane of klm
+bool isOutOfReach(const Vector_3_Z &a, const Vector_3_Z &b, const Vector_3_Z &c,
+                  const Vector_3_Z &k, const Vector_3_Z &l, const Vector_3_Z &m)
+{
+    Z maximumSquaredRadius = std::max(a.squared_length(), std::max(b.squared_length(), c.squared_length()));
+
+    // squared distance of the plane is (n * k)^2 / |n|^2, a lower bound of the triangle distance
+    Vector_3_Z normal = CGAL::cross_product(l - k, m - k);
+    Z normalSquaredLength = normal.squared_length();
+
+    if (normalSquaredLength == Z(0))
+        return false;
+
+    Z planeDistance = normal * k;
+
+    return maximumSquaredRadius * normalSquaredLength < planeDistance * planeDistance;
+}
+} // namespace anonymous
 
 std::vector<VariantPredicate> triTriPredicateList(
         const Vector_3_Z &a, const Vector_3_Z &b, const Vector_3_Z &c,
@@ -27,7 +49,8 @@ std::vector<VariantPredicate> triTriPredicateList(
     if (optimize)
     {
         // radius check
-        //RT maxRadius = std::max(a.length())
+        if (isOutOfReach(a, b, c, k, l, m) || isOutOfReach(k, l, m, a, b, c))
+            return std::vector<VariantPredicate>();
     }
 
     VariantPredicate predicates[4];
@@ -29,7 +29,7 @@ namespace
     static Kernel_R r_kernel;
 }
 
-void clearAndParse(const std::string &str, CGAL::Bigint &out)
+void clearAndParse(const std::string &str, Z &out)
 {
     std::string clearStr;
 
@@ -37,7 +37,7 @@ void clearAndParse(const std::string &str, CGAL::Bigint &out)
         if (*i != ' ' && *i != ';')
             clearStr += *i;
 
-    LiDIA::string_to_bigint(clearStr.c_str(), out);
+    stringToZ(clearStr.c_str(), out);
 }
 
 void clearAndParse(const std::string &str, double &out)
@@ -64,7 +64,7 @@ Vector_3_Z toVector_3(const std::string &text, bool *ok)
         return Vector_3_Z(0, 0, 0);
     }
 
-    CGAL::Bigint x, y, z;
+    Z x, y, z;
 
     clearAndParse(parts[0], x);
     clearAndParse(parts[1], y);
@@ -114,7 +114,7 @@ Plane_3_Z toPlane_3(const std::string &text, bool *ok)
         return Plane_3_Z();
     }
 
-    CGAL::Bigint a, b, c, d;
+    Z a, b, c, d;
 
     clearAndParse(parts[0], a);
     clearAndParse(parts[1], b);
@@ -127,9 +127,9 @@ Plane_3_Z toPlane_3(const std::string &text, bool *ok)
     return Plane_3_Z(a, b, c, d);
 }
 
-CGAL::Bigint toNumber(const std::string &text, bool *ok)
+Z toNumber(const std::string &text, bool *ok)
 {
-    CGAL::Bigint result;
+    Z result;
     clearAndParse(text, result);
     if (ok) *ok = true;
     return result;
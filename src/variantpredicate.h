@@ -70,6 +70,6 @@ struct VariantPredicate
 Vector_3_Z      toVector_3(const std::string &text, bool *ok = 0);
 Mesh_point_3_Z  toMesh_point_3(const std::string &text, bool *ok = 0);
 Plane_3_Z       toPlane_3(const std::string &text, bool *ok = 0);
-CGAL::Bigint    toNumber(const std::string &text, bool *ok = 0);
+Z               toNumber(const std::string &text, bool *ok = 0);
 
 #endif // PREDICATE_H
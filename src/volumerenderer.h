@@ -29,31 +29,6 @@ enum VoxelType
     VoxelType_Border
 };
 
-struct Voxel
-{
-    Voxel()
-        : type(VoxelType_Border),
-          x(0),
-          y(0),
-          z(0)
-    {
-    }
-
-    Voxel(VoxelType type_,
-          double x_,
-          double y_,
-          double z_)
-        : type(type_),
-          x(x_),
-          y(y_),
-          z(z_)
-    {
-    }
-
-    VoxelType type;
-    double x, y, z;
-};
-
 class VolumeRenderer
 {
 public:
@@ -21,6 +21,7 @@
 #include "material.h"
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkCellArray.h>
+#include <vtkFloatArray.h>
 #include <vtkObjectFactory.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
@@ -40,8 +41,8 @@ public:
     vtkTypeMacro(VoxelGridReader, vtkPolyDataAlgorithm)
     void PrintSelf(std::ostream &os, vtkIndent indent);
 
-    vtkSetMacro(Voxels, const VoxelType *)
-    vtkGetMacro(Voxels, const VoxelType *)
+    vtkSetMacro(Voxels, const VoxelStore *)
+    vtkGetMacro(Voxels, const VoxelStore *)
 
     vtkSetMacro(Resolution, size_t)
     vtkGetMacro(Resolution, size_t)
@@ -53,7 +54,7 @@ protected:
     VoxelGridReader();
     ~VoxelGridReader();
 
-    const VoxelType *   Voxels;
+    const VoxelStore *  Voxels;
     size_t              Resolution;
     VoxelType           Type;
 
@@ -97,22 +98,24 @@ int VoxelGridReader::RequestData(vtkInformation *, vtkInformationVector **, vtkI
     vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
     vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
 
-    // Copy texels to points
-    for (size_t u = 0; u < Resolution; ++u)
+    // Copy texels to points (in storage order, the voxels may be paged)
+    size_t index = 0;
+
+    for (size_t w = 0; w < Resolution; ++w)
     {
         for (size_t v = 0; v < Resolution; ++v)
         {
-            for (size_t w = 0; w < Resolution; ++w)
+            for (size_t u = 0; u < Resolution; ++u)
             {
-                // calculate random sample
-                double s12 = 2.0 * double(u) / double(Resolution - 1) - 1.0;
-                double s23 = 2.0 * double(v) / double(Resolution - 1) - 1.0;
-                double s31 = 2.0 * double(w) / double(Resolution - 1) - 1.0;
-
-                VoxelType voxelType = Voxels[Resolution * (Resolution * w + v) + u];
+                VoxelType voxelType = Voxels->at(index++);
 
                 if (voxelType == Type)
                 {
+                    // calculate random sample
+                    double s12 = 2.0 * double(u) / double(Resolution - 1) - 1.0;
+                    double s23 = 2.0 * double(v) / double(Resolution - 1) - 1.0;
+                    double s31 = 2.0 * double(w) / double(Resolution - 1) - 1.0;
+
                     vtkIdType id = points->InsertNextPoint(s12, s23, s31);
                     cellArray->InsertNextCell(1, &id);
                 }
@@ -128,137 +131,53 @@ int VoxelGridReader::RequestData(vtkInformation *, vtkInformationVector **, vtkI
     return 1;
 }
 
-class /*VTK_IO_EXPORT*/ VoxelListReader
-    : public vtkPolyDataAlgorithm
+namespace // anonymous
 {
-public:
-    static VoxelListReader* New();
-    vtkTypeMacro(VoxelListReader, vtkPolyDataAlgorithm)
-    void PrintSelf(std::ostream &os, vtkIndent indent);
-
-    vtkSetMacro(VoxelsBegin, const Voxel *)
-    vtkGetMacro(VoxelsBegin, const Voxel *)
-
-    vtkSetMacro(VoxelsEnd, const Voxel *)
-    vtkGetMacro(VoxelsEnd, const Voxel *)
-
-    vtkSetMacro(Type, VoxelType)
-    vtkGetMacro(Type, VoxelType)
-
-protected:
-    VoxelListReader();
-    ~VoxelListReader();
-
-    const Voxel *       VoxelsBegin;
-    const Voxel *       VoxelsEnd;
-    VoxelType           Type;
-
-    int RequestData(vtkInformation *,
-                    vtkInformationVector **,
-                    vtkInformationVector *);
-private:
-    VoxelListReader(const VoxelListReader &);
-    void operator=(const VoxelListReader &);
-};
-
-vtkStandardNewMacro(VoxelListReader)
-
-VoxelListReader::VoxelListReader()
+vtkSmartPointer<vtkPoints> wrapPoints(const VoxelPointSet &voxels, VoxelType type)
 {
-    VoxelsBegin = 0;
-    VoxelsEnd = 0;
-    Type = VoxelType_Imaginary;
-    SetNumberOfInputPorts(0);
-}
+    // the point set outlives the pipeline, VTK must not free it
+    vtkSmartPointer<vtkFloatArray> coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetArray(const_cast<float *>(voxels.data(type)), static_cast<vtkIdType>(3 * voxels.size(type)), 1);
 
-VoxelListReader::~VoxelListReader()
-{
-}
-
-void VoxelListReader::PrintSelf(ostream& os, vtkIndent indent)
-{
-    Superclass::PrintSelf(os,indent);
-}
-
-int VoxelListReader::RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *outputVector)
-{
-    // Make sure we have a file to read.
-    if (!VoxelsBegin || !VoxelsEnd)
-    {
-        vtkErrorMacro("No voxel begin or voxel end specified");
-        return 0;
-    }
-
-    // Allocate objects to hold points and vertex cells.
     vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> cellArray = vtkSmartPointer<vtkCellArray>::New();
-
-    // Copy texels to points
-    const Voxel *current = VoxelsBegin;
-
-    while (current != VoxelsEnd)
-    {
-        if (current->type == Type)
-        {
-            vtkIdType id = points->InsertNextPoint(current->x, current->y, current->z);
-            cellArray->InsertNextCell(1, &id);
-        }
+    points->SetData(coordinates);
 
-        ++current;
-    }
-
-    // Store the points and cells in the output data object.
-    vtkPolyData* output = vtkPolyData::GetData(outputVector);
-    output->SetPoints(points);
-    output->SetVerts(cellArray);
-
-    return 1;
+    return points;
 }
+} // namespace anonymous
 
-VolumeRendererGaussianSplatter::VolumeRendererGaussianSplatter(const VoxelType *voxels, size_t resolution, QGLWidget *gl)
+VolumeRendererGaussianSplatter::VolumeRendererGaussianSplatter(const VoxelStore &voxels, size_t resolution, QGLWidget *gl)
 {
     // prepare data sources
     vtkSmartPointer<VoxelGridReader> dataSourceRealFull = vtkSmartPointer<VoxelGridReader>::New();
-    dataSourceRealFull->SetVoxels(voxels);
+    dataSourceRealFull->SetVoxels(&voxels);
     dataSourceRealFull->SetType(VoxelType_Real_Full);
     dataSourceRealFull->SetResolution(resolution);
     dataSourceRealFull->Update();
 
     vtkSmartPointer<VoxelGridReader> dataSourceRealMixed = vtkSmartPointer<VoxelGridReader>::New();
-    dataSourceRealMixed->SetVoxels(voxels);
+    dataSourceRealMixed->SetVoxels(&voxels);
     dataSourceRealMixed->SetType(VoxelType_Real_Mixed);
     dataSourceRealMixed->SetResolution(resolution);
     dataSourceRealMixed->Update();
 
     // create triangle lists
-    m_triangleListMeshFull = meshVoxels(dataSourceRealFull, gl);
-    m_triangleListMeshMixed = meshVoxels(dataSourceRealMixed, gl);
+    m_triangleListMeshFull = meshPoints(dataSourceRealFull->GetOutput()->GetPoints(), gl);
+    m_triangleListMeshMixed = meshPoints(dataSourceRealMixed->GetOutput()->GetPoints(), gl);
 }
 
-VolumeRendererGaussianSplatter::VolumeRendererGaussianSplatter(const Voxel *begin, const Voxel *end, QGLWidget *gl)
+VolumeRendererGaussianSplatter::VolumeRendererGaussianSplatter(const VoxelPointSet &voxels, QGLWidget *gl)
 {
-    // prepare data sources
-    vtkSmartPointer<VoxelListReader> dataSourceRealFull = vtkSmartPointer<VoxelListReader>::New();
-    dataSourceRealFull->SetVoxelsBegin(begin);
-    dataSourceRealFull->SetVoxelsEnd(end);
-    dataSourceRealFull->SetType(VoxelType_Real_Full);
-    dataSourceRealFull->Update();
-
-    vtkSmartPointer<VoxelListReader> dataSourceRealMixed = vtkSmartPointer<VoxelListReader>::New();
-    dataSourceRealMixed->SetVoxelsBegin(begin);
-    dataSourceRealMixed->SetVoxelsEnd(end);
-    dataSourceRealMixed->SetType(VoxelType_Real_Mixed);
-    dataSourceRealMixed->Update();
-
     // create triangle lists
-    m_triangleListMeshFull = meshVoxels(dataSourceRealFull, gl);
-    m_triangleListMeshMixed = meshVoxels(dataSourceRealMixed, gl);
+    m_triangleListMeshFull = meshPoints(wrapPoints(voxels, VoxelType_Real_Full), gl);
+    m_triangleListMeshMixed = meshPoints(wrapPoints(voxels, VoxelType_Real_Mixed), gl);
 }
 
-TriangleListMeshPtr VolumeRendererGaussianSplatter::meshVoxels(vtkPolyDataAlgorithm *dataSource, QGLWidget *gl)
+TriangleListMeshPtr VolumeRendererGaussianSplatter::meshPoints(vtkPoints *points, QGLWidget *gl)
 {
     vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-    polyData->SetPoints(dataSource->GetOutput()->GetPoints());
+    polyData->SetPoints(points);
 
     vtkSmartPointer<vtkGaussianSplatter> gaussianSplatter = vtkSmartPointer<vtkGaussianSplatter>::New();
     gaussianSplatter->SetInputData(polyData);
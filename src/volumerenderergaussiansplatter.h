@@ -21,18 +21,20 @@
 #define VOLUMERENDERERMARCHINGCUBES_H
 
 #include "volumerenderer.h"
+#include "voxelstore.h"
+#include "voxelpointset.h"
 #include "trianglelistmesh.h"
 #include <cstdlib>
 
-class vtkPolyDataAlgorithm;
+class vtkPoints;
 class QGLWidget;
 
 class VolumeRendererGaussianSplatter
     : public VolumeRenderer
 {
 public:
-    VolumeRendererGaussianSplatter(const VoxelType *voxels, size_t resolution, QGLWidget *gl);
-    VolumeRendererGaussianSplatter(const Voxel *begin, const Voxel *end, QGLWidget *gl);
+    VolumeRendererGaussianSplatter(const VoxelStore &voxels, size_t resolution, QGLWidget *gl);
+    VolumeRendererGaussianSplatter(const VoxelPointSet &voxels, QGLWidget *gl);
 
     virtual void render();
 
@@ -40,7 +42,7 @@ private:
     TriangleListMeshPtr m_triangleListMeshFull;
     TriangleListMeshPtr m_triangleListMeshMixed;
 
-    TriangleListMeshPtr meshVoxels(vtkPolyDataAlgorithm *dataSource, QGLWidget *gl);
+    TriangleListMeshPtr meshPoints(vtkPoints *points, QGLWidget *gl);
 };
 
 #endif // VOLUMERENDERERMARCHINGCUBES_H
@@ -37,53 +37,61 @@ inline void generateBoxTexCoordAndVertex3f(float x, float y, float z)
 }
 } // namespace anonymous
 
-VolumeRendererTexture3D::VolumeRendererTexture3D(const VoxelType *voxels, size_t resolution, QGLWidget *gl)
+VolumeRendererTexture3D::VolumeRendererTexture3D(const VoxelStore &voxels, size_t resolution, QGLWidget *gl)
 {
     (void)gl;
 
-    boost::scoped_array<unsigned char> data(new unsigned char[resolution * resolution * resolution * 3]);
+    size_t textureResolution = resolution < MAXIMUM_TEXTURE_RESOLUTION ? resolution : MAXIMUM_TEXTURE_RESOLUTION;
+    size_t step = resolution / textureResolution;
+
+    boost::scoped_array<unsigned char> data(new unsigned char[textureResolution * textureResolution * textureResolution * 3]);
 
     size_t index = 0;
-    size_t count = resolution * resolution * resolution;
 
-    // scan points
-    for (size_t i = 0; i < count; ++i)
+    // scan points in storage order
+    for (size_t a = 0; a < textureResolution; ++a)
     {
-        switch (voxels[i])
+        for (size_t b = 0; b < textureResolution; ++b)
         {
-        case VoxelType_Border:
-            data[index++] = 64;
-            data[index++] = 64;
-            data[index++] = 64;
-            break;
-
-        case VoxelType_Imaginary:
-            data[index++] = 32;
-            data[index++] = 32;
-            data[index++] = 32;
-            break;
-
-        case VoxelType_Real_Empty:
-            data[index++] = 0;
-            data[index++] = 255;
-            data[index++] = 0;
-            break;
-
-        case VoxelType_Real_Full:
-            data[index++] = 255;
-            data[index++] = 0;
-            data[index++] = 0;
-            break;
-
-        case VoxelType_Real_Mixed:
-            data[index++] = 255;
-            data[index++] = 255;
-            data[index++] = 0;
-            break;
+            for (size_t c = 0; c < textureResolution; ++c)
+            {
+                switch (voxels.at(resolution * (resolution * (a * step) + b * step) + c * step))
+                {
+                case VoxelType_Border:
+                    data[index++] = 64;
+                    data[index++] = 64;
+                    data[index++] = 64;
+                    break;
+
+                case VoxelType_Imaginary:
+                    data[index++] = 32;
+                    data[index++] = 32;
+                    data[index++] = 32;
+                    break;
+
+                case VoxelType_Real_Empty:
+                    data[index++] = 0;
+                    data[index++] = 255;
+                    data[index++] = 0;
+                    break;
+
+                case VoxelType_Real_Full:
+                    data[index++] = 255;
+                    data[index++] = 0;
+                    data[index++] = 0;
+                    break;
+
+                case VoxelType_Real_Mixed:
+                    data[index++] = 255;
+                    data[index++] = 255;
+                    data[index++] = 0;
+                    break;
+                }
+            }
         }
     }
 
-    build3DTexture(data.get(), resolution);
+    build3DTexture(data.get(), textureResolution);
 }
 
 void VolumeRendererTexture3D::render()
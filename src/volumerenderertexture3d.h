@@ -21,6 +21,7 @@
 #define VOLUMERENDERERTEXTURE3D_H
 
 #include "volumerenderer.h"
+#include "voxelstore.h"
 #include <cstdlib>
 
 class QGLWidget;
@@ -29,7 +30,10 @@ class VolumeRendererTexture3D
     : public VolumeRenderer
 {
 public:
-    VolumeRendererTexture3D(const VoxelType *voxels, size_t resolution, QGLWidget *gl);
+    // larger rasters are point-sampled down to this texture size
+    static const size_t MAXIMUM_TEXTURE_RESOLUTION = 256;
+
+    VolumeRendererTexture3D(const VoxelStore &voxels, size_t resolution, QGLWidget *gl);
 
     virtual void render();
 
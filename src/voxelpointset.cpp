@@ -0,0 +1,48 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "voxelpointset.h"
+
+VoxelPointSet::VoxelPointSet()
+{
+}
+
+void VoxelPointSet::reserve(VoxelType type, size_t count)
+{
+    m_points[type].reserve(3 * count);
+}
+
+void VoxelPointSet::add(VoxelType type, double x, double y, double z)
+{
+    std::vector<float> &points = m_points[type];
+
+    points.push_back(static_cast<float>(x));
+    points.push_back(static_cast<float>(y));
+    points.push_back(static_cast<float>(z));
+}
+
+size_t VoxelPointSet::size(VoxelType type) const
+{
+    return m_points[type].size() / 3;
+}
+
+const float *VoxelPointSet::data(VoxelType type) const
+{
+    return m_points[type].empty() ? 0 : &m_points[type][0];
+}
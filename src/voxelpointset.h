@@ -0,0 +1,52 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VOXELPOINTSET_H
+#define VOXELPOINTSET_H
+
+#include "volumerenderer.h"
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <vector>
+
+// sample points partitioned by voxel type
+//
+// each type is one packed array of float x, y, z triples, the layout of
+// VTK point arrays, so renderers can use it without copying
+class VoxelPointSet
+    : private boost::noncopyable
+{
+public:
+    static const int NUMBER_OF_TYPES = VoxelType_Border + 1;
+
+    VoxelPointSet();
+
+    void            reserve(VoxelType type, size_t count);
+    void            add(VoxelType type, double x, double y, double z);
+
+    size_t          size(VoxelType type) const;
+
+    // 3 * size(type) coordinates
+    const float *   data(VoxelType type) const;
+
+private:
+    std::vector<float>  m_points[NUMBER_OF_TYPES];
+};
+
+#endif // VOXELPOINTSET_H
@@ -0,0 +1,205 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "voxelstore.h"
+#include <QDir>
+#include <QSettings>
+#include <QStandardPaths>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+namespace // anonymous
+{
+const size_t NO_BLOCK = static_cast<size_t>(-1);
+
+QString backingDirectory()
+{
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, "arrangement", "arrangement");
+    QString directory = settings.value("voxelStoreDirectory").toString();
+
+    if (directory.isEmpty())
+    {
+        QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+        if (root.isEmpty())
+            root = QDir::homePath() + "/.arrangement";
+
+        directory = root + "/voxels";
+    }
+
+    QDir().mkpath(directory);
+    return directory;
+}
+} // namespace anonymous
+
+VoxelStore::VoxelStore(size_t size, size_t maximumResidentBlocks)
+    : m_size(size),
+      m_numberOfBlocks((size + BLOCK_SIZE - 1) / BLOCK_SIZE),
+      m_maximumResidentBlocks(maximumResidentBlocks ? maximumResidentBlocks : 1),
+      m_file(-1),
+      m_blocks(m_numberOfBlocks, static_cast<unsigned char *>(0)),
+      m_lruPositions(m_numberOfBlocks),
+      m_lastBlock(NO_BLOCK),
+      m_lastBlockData(0)
+{
+    // create an anonymous backing file; it disappears with the last descriptor
+    std::string path = backingDirectory().toStdString() + "/arrangement-voxels-XXXXXX";
+    std::vector<char> pathBuffer(path.begin(), path.end());
+    pathBuffer.push_back('\0');
+
+    m_file = mkstemp(&pathBuffer[0]);
+
+    if (m_file == -1)
+        throw std::runtime_error("VoxelStore: failed to create backing file!");
+
+    unlink(&pathBuffer[0]);
+
+    // sparse file, reads as zeros (VoxelType_Real_Empty) until written
+    if (ftruncate(m_file, static_cast<off_t>(m_size)) != 0)
+    {
+        close(m_file);
+        throw std::runtime_error("VoxelStore: failed to resize backing file!");
+    }
+}
+
+VoxelStore::~VoxelStore()
+{
+    for (size_t block = 0; block < m_numberOfBlocks; ++block)
+        if (m_blocks[block])
+            unmapBlock(block);
+
+    close(m_file);
+}
+
+size_t VoxelStore::size() const
+{
+    return m_size;
+}
+
+VoxelType VoxelStore::at(size_t index) const
+{
+    assert(index < m_size);
+    return static_cast<VoxelType>(residentBlock(index / BLOCK_SIZE)[index % BLOCK_SIZE]);
+}
+
+void VoxelStore::set(size_t index, VoxelType type)
+{
+    assert(index < m_size);
+    residentBlock(index / BLOCK_SIZE)[index % BLOCK_SIZE] = static_cast<unsigned char>(type);
+}
+
+size_t VoxelStore::numberOfBlocks() const
+{
+    return m_numberOfBlocks;
+}
+
+size_t VoxelStore::blockSize(size_t block) const
+{
+    assert(block < m_numberOfBlocks);
+
+    if (block + 1 == m_numberOfBlocks)
+        return m_size - block * BLOCK_SIZE;
+
+    return BLOCK_SIZE;
+}
+
+const unsigned char *VoxelStore::blockData(size_t block) const
+{
+    return residentBlock(block);
+}
+
+unsigned char *VoxelStore::blockData(size_t block)
+{
+    return residentBlock(block);
+}
+
+unsigned char *VoxelStore::residentBlock(size_t block) const
+{
+    // sequential access stays within one block most of the time
+    if (block == m_lastBlock)
+        return m_lastBlockData;
+
+    assert(block < m_numberOfBlocks);
+
+    if (m_blocks[block])
+    {
+        // touch
+        m_lru.splice(m_lru.begin(), m_lru, m_lruPositions[block]);
+    }
+    else
+    {
+        // make room
+        if (m_lru.size() >= m_maximumResidentBlocks)
+            unmapBlock(m_lru.back());
+
+        m_blocks[block] = mapBlock(block);
+        m_lru.push_front(block);
+        m_lruPositions[block] = m_lru.begin();
+
+        // iteration goes forward, ask the kernel to read ahead
+        if (block + 1 < m_numberOfBlocks)
+            prefetchBlock(block + 1);
+    }
+
+    m_lastBlock = block;
+    m_lastBlockData = m_blocks[block];
+    return m_lastBlockData;
+}
+
+unsigned char *VoxelStore::mapBlock(size_t block) const
+{
+    size_t length = blockSize(block);
+
+    void *data = mmap(0, length, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, static_cast<off_t>(block * BLOCK_SIZE));
+
+    if (data == MAP_FAILED)
+        throw std::runtime_error("VoxelStore: failed to map block!");
+
+    madvise(data, length, MADV_SEQUENTIAL);
+
+    return static_cast<unsigned char *>(data);
+}
+
+void VoxelStore::unmapBlock(size_t block) const
+{
+    // dirty pages are written back to the backing file by the kernel
+    munmap(m_blocks[block], blockSize(block));
+    m_blocks[block] = 0;
+
+    m_lru.erase(m_lruPositions[block]);
+
+    if (block == m_lastBlock)
+    {
+        m_lastBlock = NO_BLOCK;
+        m_lastBlockData = 0;
+    }
+}
+
+void VoxelStore::prefetchBlock(size_t block) const
+{
+    if (m_blocks[block])
+        madvise(m_blocks[block], blockSize(block), MADV_WILLNEED);
+    else
+        posix_fadvise(m_file, static_cast<off_t>(block * BLOCK_SIZE), static_cast<off_t>(blockSize(block)), POSIX_FADV_WILLNEED);
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2009-2013  Przemysław Dobrowolski
+ *
+ * This file is part of the Configuration Space Library (libcs), a library
+ * for creating configuration spaces of various motion planning problems.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef VOXELSTORE_H
+#define VOXELSTORE_H
+
+#include "volumerenderer.h"
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <list>
+#include <vector>
+
+// a paged voxel store backed by an unlinked file in an on-disk cache
+// directory, the "voxelStoreDirectory" setting or the user cache location
+// by default; the temporary directory is avoided since it is often a
+// memory-backed tmpfs
+//
+// voxels are kept one byte each in fixed-size blocks; at most
+// maximumResidentBlocks blocks are mapped at once and the least
+// recently used one is unmapped when another block is needed,
+// so rasters larger than the physical memory can be processed
+//
+// note: the store is not thread-safe, even for const access
+class VoxelStore
+    : private boost::noncopyable
+{
+public:
+    static const size_t BLOCK_SIZE = 1 << 22;                     // 4 MiB per block
+    static const size_t DEFAULT_MAXIMUM_RESIDENT_BLOCKS = 64;     // 256 MiB resident
+
+    explicit VoxelStore(size_t size, size_t maximumResidentBlocks = DEFAULT_MAXIMUM_RESIDENT_BLOCKS);
+    ~VoxelStore();
+
+    size_t                  size() const;
+
+    VoxelType               at(size_t index) const;
+    void                    set(size_t index, VoxelType type);
+
+    // block access for bulk transfers; the returned pointer is valid
+    // until a different block is accessed
+    size_t                  numberOfBlocks() const;
+    size_t                  blockSize(size_t block) const;
+
+    const unsigned char *   blockData(size_t block) const;
+    unsigned char *         blockData(size_t block);
+
+private:
+    typedef std::list<size_t>   Lru;
+
+    size_t                  m_size;
+    size_t                  m_numberOfBlocks;
+    size_t                  m_maximumResidentBlocks;
+    int                     m_file;
+
+    // resident blocks, most recently used first
+    mutable std::vector<unsigned char *>    m_blocks;
+    mutable std::vector<Lru::iterator>      m_lruPositions;
+    mutable Lru                             m_lru;
+
+    // fast path for sequential access
+    mutable size_t                          m_lastBlock;
+    mutable unsigned char *                 m_lastBlockData;
+
+    unsigned char *         residentBlock(size_t block) const;
+    unsigned char *         mapBlock(size_t block) const;
+    void                    unmapBlock(size_t block) const;
+    void                    prefetchBlock(size_t block) const;
+};
+
+#endif // VOXELSTORE_H